@@ -1,13 +1,26 @@
 #pragma once
 
+#include "include/adaptive.hpp"
 #include "include/aqua.hpp"
 #include "include/city.hpp"
+#include "include/columnar.hpp"
+#include "include/composite.hpp"
+#include "include/dispatch.hpp"
+#include "include/file.hpp"
 #include "include/meow.hpp"
 #include "include/mult.hpp"
 #include "include/murmur.hpp"
 #include "include/reduction.hpp"
+#include "include/registry.hpp"
+#include "include/streaming.hpp"
 #include "include/tabulation.hpp"
 #include "include/xxh.hpp"
 
+#include "include/filter/blocked_bloom.hpp"
+#include "include/filter/cuckoo.hpp"
+#include "include/filter/xor.hpp"
+#include "include/sketch/count_min.hpp"
+#include "include/sketch/hyperloglog.hpp"
+
 // Order is important
 #include "include/convenience/undef.hpp"
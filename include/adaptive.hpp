@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "registry.hpp"
+#include "types.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::adaptive {
+   /**
+    * Hash function and reducer pair, identified by their registry names
+    */
+   struct Candidate {
+      std::string hashfn;
+      std::string reducer;
+   };
+
+   /**
+    * Outcome of probing a single candidate on a key sample
+    */
+   struct Probe {
+      Candidate candidate;
+
+      /// observed bucket load variance divided by the variance expected from an
+      /// ideal random function. ~1 is ideal, less is better than random (e.g.,
+      /// multiplicative hashing of sequential keys), much larger indicates clustering
+      double variance_ratio;
+
+      /// time spent hashing and reducing the sample, in nanoseconds per key
+      double ns_per_key;
+   };
+
+   struct Options {
+      /// maximum amount of sampled keys
+      size_t sample_size = 1 << 16;
+
+      /// keys are sampled in contiguous runs of this length, evenly spread across
+      /// the input. Runs preserve local structure, e.g., gaps, which cheap functions
+      /// are most sensitive to
+      size_t run_length = 1024;
+
+      /// amount of buckets relative to the sample size, i.e., the probed load factor is 1 / buckets_per_key
+      double buckets_per_key = 1.0;
+
+      /// candidates are timed this many times, keeping the fastest measurement
+      size_t timing_rounds = 3;
+   };
+
+   /**
+    * Cheapest candidates first, ending with a strong general purpose function. The
+    * multiplicative hashes concentrate entropy in their upper bits and are therefore
+    * paired with fastrange, which consumes those
+    */
+   template<class Key>
+   std::vector<Candidate> default_candidates() {
+      static_assert(std::is_same_v<Key, HASH_32> || std::is_same_v<Key, HASH_64>,
+                    "default candidates are only available for 32 and 64 bit keys");
+      const std::string bits = std::to_string(sizeof(Key) * 8);
+
+      return {{"MultFibonacci" + bits, "fastrange" + bits},
+              {"MultFibonacciPrime" + bits, "fastrange" + bits},
+              {"MultHash" + bits, "fastrange" + bits},
+              {"murmur_finalizer" + bits, "fastrange" + bits},
+              {"xxh3_" + bits, "fastrange64"}};
+   }
+
+   namespace _ {
+      /**
+       * @return up to sample_size keys taken in evenly spaced contiguous runs
+       */
+      template<class Key>
+      std::vector<Key> sample(const Key* keys, const size_t& n, const Options& options) {
+         if (n <= options.sample_size)
+            return std::vector<Key>(keys, keys + n);
+
+         const size_t run_length = std::clamp(options.run_length, static_cast<size_t>(1), options.sample_size);
+         const size_t runs = options.sample_size / run_length;
+         const size_t stride = n / runs;
+
+         std::vector<Key> res;
+         res.reserve(runs * run_length);
+         for (size_t r = 0; r < runs; r++)
+            res.insert(res.end(), keys + r * stride, keys + r * stride + run_length);
+         return res;
+      }
+   } // namespace _
+
+   /**
+    * Probes each candidate on a sample of keys, measuring how evenly it
+    * distributes them across buckets and how long it takes to do so.
+    * Candidates that are not registered (e.g., since the cpu does not
+    * support them) are skipped
+    *
+    * @param keys input keys, e.g., a column
+    * @param n amount of keys
+    * @param candidates hash function and reducer pairs to probe
+    * @throws std::out_of_range if a reducer name is unknown
+    * @throws std::invalid_argument if a reducer produces indices outside of [0, buckets),
+    *    e.g., do_nothing64
+    */
+   template<class Key>
+   std::vector<Probe> probe(const Key* keys, const size_t& n,
+                            const std::vector<Candidate>& candidates = default_candidates<Key>(),
+                            const Options& options = Options()) {
+      const auto& registry = registry::Registry<Key>::defaults();
+
+      const auto sample = _::sample(keys, n, options);
+      const size_t buckets =
+         std::max(static_cast<size_t>(static_cast<double>(sample.size()) * options.buckets_per_key), static_cast<size_t>(1));
+      const double load = static_cast<double>(sample.size()) / static_cast<double>(buckets);
+      // loads of an ideal random function are binomially distributed
+      const double expected_variance = load * (1.0 - 1.0 / static_cast<double>(buckets));
+
+      std::vector<HASH_64> indices(sample.size());
+      std::vector<std::uint32_t> loads(buckets);
+      std::vector<Probe> res;
+
+      for (const auto& candidate : candidates) {
+         if (!registry.contains(candidate.hashfn))
+            continue;
+         const auto& hashfn = registry.get(candidate.hashfn);
+         const auto reducer = registry::make_reducer(candidate.reducer, buckets);
+
+         double best = std::numeric_limits<double>::max();
+         for (size_t round = 0; round < std::max(options.timing_rounds, static_cast<size_t>(1)); round++) {
+            const auto start = std::chrono::steady_clock::now();
+            hashfn(sample.data(), sample.size(), indices.data());
+            reducer(indices.data(), indices.size(), indices.data());
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+         }
+
+         std::fill(loads.begin(), loads.end(), 0);
+         for (const auto& index : indices) {
+            if (unlikely(index >= buckets))
+               throw std::invalid_argument("reducer '" + candidate.reducer + "' does not map " + candidate.hashfn +
+                                           " into [0, " + std::to_string(buckets) + ")");
+            loads[index]++;
+         }
+
+         double variance = 0;
+         for (const auto& l : loads)
+            variance += (l - load) * (l - load);
+         variance /= static_cast<double>(buckets);
+
+         res.push_back({candidate, expected_variance > 0 ? variance / expected_variance : 1.0,
+                        sample.empty() ? 0.0 : best / static_cast<double>(sample.size())});
+      }
+
+      return res;
+   }
+
+   /**
+    * Selects the fastest candidate whose bucket load variance is at most max_variance_ratio
+    * times that of an ideal random function. If no candidate qualifies, the one with the
+    * lowest variance ratio is returned. Use registry::Registry<Key>::defaults().get() and
+    * registry::make_reducer() to instantiate the selection.
+    *
+    * @param keys input keys, e.g., a column
+    * @param n amount of keys
+    * @param max_variance_ratio quality threshold. The ratio's standard deviation for an ideal
+    *    function on the default sample is roughly 0.01, i.e., 1.1 rejects only actual clustering
+    * @param candidates hash function and reducer pairs to consider
+    * @throws std::runtime_error if none of the candidates is available
+    * @throws std::invalid_argument if a reducer produces indices outside of [0, buckets)
+    */
+   template<class Key>
+   Probe select(const Key* keys, const size_t& n, const double& max_variance_ratio = 1.1,
+                const std::vector<Candidate>& candidates = default_candidates<Key>(),
+                const Options& options = Options()) {
+      const auto probes = probe(keys, n, candidates, options);
+      if (probes.empty())
+         throw std::runtime_error("none of the candidate hash functions is available");
+
+      const Probe* best = nullptr;
+      for (const auto& p : probes)
+         if (p.variance_ratio <= max_variance_ratio && (best == nullptr || p.ns_per_key < best->ns_per_key))
+            best = &p;
+
+      if (best == nullptr)
+         best = &*std::min_element(probes.begin(), probes.end(),
+                                   [](const Probe& a, const Probe& b) { return a.variance_ratio < b.variance_ratio; });
+      return *best;
+   }
+} // namespace hashing::adaptive
@@ -222,16 +222,22 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <limits>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <smmintrin.h>
 #include <wmmintrin.h>
 
-#include "convenience/builtins.hpp"
+#include "dispatch.hpp"
 #include "reduction.hpp"
 
+// Order important
+#include "convenience/builtins.hpp"
+
 namespace hashing {
    template<class T, const int select = 0>
    struct AquaHash {
@@ -239,14 +245,313 @@ namespace hashing {
          return "aqua" + std::to_string(select) + "_" + std::to_string(sizeof(T) * 8);
       }
 
-      AquaHash(){};
+      /// requires AES-NI, may only be executed if dispatch::supported<AquaHash>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      /**
+       * @param initialize seed of the one-shot operator() and of the incremental hashing state,
+       *    see Initialize()
+       */
+      explicit AquaHash(const __m128i initialize = _mm_setzero_si128())
+         : block{_mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b)),
+                 _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69)),
+                 _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e)),
+                 _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a))},
+           input{}, initialize(initialize), input_bytes(0), seed(initialize) {}
+
+      /**
+       * @param seed replicated into both 64-bit halves of the 128-bit seed, i.e., 0 is the default seed
+       */
+      explicit AquaHash(const HASH_64& seed) : AquaHash(_mm_set1_epi64x(static_cast<long long>(seed))) {}
+
+      forceinline_sse42aes T operator()(const T& value) const {
+         return (*this)(value, seed);
+      }
+
+      forceinline_sse42aes T operator()(const T& value, const __m128i seed) const {
+         return extract(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(T), seed));
+      }
+
+      forceinline_sse42aes T operator()(const std::string_view& key) const {
+         return (*this)(key, seed);
+      }
 
-      forceinline T operator()(const T& value, const __m128i seed = _mm_setzero_si128()) const;
+      /**
+       * Hashes arbitrary bytes. Keys of at least 64 bytes are processed by the large key algorithm
+       */
+      forceinline_sse42aes T operator()(const std::string_view& key, const __m128i seed) const {
+         return extract(Hash(reinterpret_cast<const uint8_t*>(key.data()), key.size(), seed));
+      }
 
       //   forceinline __m128i operator()(const HASH_128& value, const __m128i seed = _mm_setzero_si128()) const {
       //      return Hash(&value, sizeof(HASH_128), seed);
       //   }
 
+      // INCREMENTAL HYBRID ALGORITHM
+
+      /**
+       * Resets the incremental hashing state, i.e., all previously appended input is discarded
+       */
+      void Initialize(const __m128i initialize = _mm_setzero_si128()) {
+         this->initialize = initialize;
+         this->input_bytes = 0;
+         block[0] = _mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b));
+         block[1] = _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69));
+         block[2] = _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e));
+         block[3] = _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a));
+      }
+
+      /**
+       * Appends key to the hashed input. Full 512-bit blocks are consumed directly from key,
+       * only a partial trailing block is buffered. Appending a key in arbitrary chunks
+       * therefore yields the same hash as hashing it at once
+       */
+      target_sse42aes void Update(const uint8_t* key, size_t bytes) {
+         assert(input_bytes != finalized);
+         assert(bytes <= max_input && max_input - input_bytes >= bytes);
+
+         if (bytes == 0)
+            return;
+
+         // input buffer may be partially filled
+         if (input_bytes % sizeof(input)) {
+            // pointer to first unused byte in input buffer
+            uint8_t* ptr8 = reinterpret_cast<uint8_t*>(input) + (input_bytes % sizeof(input));
+
+            // compute initial copy size from key to input buffer
+            const size_t copy_size = std::min(sizeof(input) - (input_bytes % sizeof(input)), bytes);
+
+            // append new key bytes to input buffer
+            std::memcpy(ptr8, key, copy_size);
+            input_bytes += copy_size;
+            bytes -= copy_size;
+
+            // input buffer not filled by update
+            if (input_bytes % sizeof(input))
+               return;
+
+            // update key pointer to first byte not in the input buffer
+            key += copy_size;
+
+            // hash input buffer
+            block[0] = _mm_aesenc_si128(block[0], input[0]);
+            block[1] = _mm_aesenc_si128(block[1], input[1]);
+            block[2] = _mm_aesenc_si128(block[2], input[2]);
+            block[3] = _mm_aesenc_si128(block[3], input[3]);
+         }
+
+         input_bytes += bytes;
+
+         // input buffer is empty
+         const __m128i* ptr128 = reinterpret_cast<const __m128i*>(key);
+         while (bytes >= sizeof(block)) {
+            block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
+            block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
+            block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
+            block[3] = _mm_aesenc_si128(block[3], _mm_loadu_si128(ptr128++));
+            bytes -= sizeof(block);
+         }
+
+         // load remaining bytes into input buffer
+         if (bytes)
+            std::memcpy(input, ptr128, bytes);
+      }
+
+      target_sse42aes void Update(const std::string_view& key) {
+         Update(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+      }
+
+      /**
+       * Generates the hash of all appended input. Afterwards, the hashing state is undefined
+       * and must be reset using Initialize() before any subsequent Update()
+       */
+      target_sse42aes __m128i Finalize() {
+         assert(input_bytes != finalized);
+         if (input_bytes < sizeof(block)) {
+            const __m128i hash = SmallKeyAlgorithm(reinterpret_cast<const uint8_t*>(input), input_bytes, initialize);
+            input_bytes = finalized;
+            return hash;
+         }
+
+         // the buffered remainder is consumed front to back, exactly like LargeKeyAlgorithm does.
+         // The reference implementation read fixed buffer slots, which only matches for remainders
+         // of at least 48 bytes (e.g., the 127 byte test vector)
+         const __m128i* ptr128 = input;
+         if (input_bytes & 32) {
+            block[0] = _mm_aesenc_si128(block[0], *ptr128++);
+            block[1] = _mm_aesenc_si128(block[1], *ptr128++);
+         }
+
+         if (input_bytes & 16) {
+            block[2] = _mm_aesenc_si128(block[2], *ptr128++);
+         }
+
+         // AES sub-block processor
+         const uint8_t* ptr8 = reinterpret_cast<const uint8_t*>(ptr128);
+         if (input_bytes & 8) {
+            __m128i b = _mm_set_epi64x(*reinterpret_cast<const uint64_t*>(ptr8), 0xa11202c9b468bea1);
+            block[3] = _mm_aesenc_si128(block[3], b);
+            ptr8 += 8;
+         }
+
+         if (input_bytes & 4) {
+            __m128i b = _mm_set_epi32(0xb1293b33, 0x05418592, *reinterpret_cast<const uint32_t*>(ptr8), 0xd210d232);
+            block[0] = _mm_aesenc_si128(block[0], b);
+            ptr8 += 4;
+         }
+
+         if (input_bytes & 2) {
+            __m128i b = _mm_set_epi16(0xbd3d, 0xc2b7, 0xb87c, 0x4715, 0x6a6c, 0x9527,
+                                      *reinterpret_cast<const uint16_t*>(ptr8), 0xac2e);
+            block[1] = _mm_aesenc_si128(block[1], b);
+            ptr8 += 2;
+         }
+
+         if (input_bytes & 1) {
+            __m128i b = _mm_set_epi8(0xcc, 0x96, 0xed, 0x16, 0x74, 0xea, 0xaa, 0x03, 0x1e, 0x86, 0x3f, 0x24, 0xb2, 0xa8,
+                                     *ptr8, 0x31);
+            block[2] = _mm_aesenc_si128(block[2], b);
+         }
+
+         // indirectly mix hashing lanes
+         const __m128i mix = _mm_xor_si128(_mm_xor_si128(block[0], block[1]), _mm_xor_si128(block[2], block[3]));
+         block[0] = _mm_aesenc_si128(block[0], mix);
+         block[1] = _mm_aesenc_si128(block[1], mix);
+         block[2] = _mm_aesenc_si128(block[2], mix);
+         block[3] = _mm_aesenc_si128(block[3], mix);
+
+         // reduction from 512-bit block size to 128-bit hash
+         __m128i hash = _mm_aesenc_si128(_mm_aesenc_si128(block[0], block[1]), _mm_aesenc_si128(block[2], block[3]));
+
+         // this algorithm construction requires no less than 1 round to finalize
+         input_bytes = finalized;
+         return _mm_aesenc_si128(hash, _mm_set_epi64x(0x8e51ef21fabb4522, 0xe43d7a0656954b6c));
+      }
+
+      /**
+       * Verifies the implementation matches test vectors computed several ways,
+       * including incremental hashing using every possible chunk size
+       *
+       * @return zero on success or line number on test failure
+       */
+      static target_sse42aes int VerifyImplementation() {
+         // A 31-byte string is the smallest key that will exercise all hash
+         // computation branches in the small key algorithm
+         static constexpr char test_key_small[] = "0123456789012345678901234567890";
+         static_assert(sizeof(test_key_small) - 1 == 31);
+
+         // A 127-byte string is the smallest key that will exercise all hash
+         // computation branches in the large key algorithm
+         static constexpr char test_key_large[] = "01234567890123456789012345678901"
+                                                  "23456789012345678901234567890123"
+                                                  "45678901234567890123456789012345"
+                                                  "6789012345678901234567890123456";
+         static_assert(sizeof(test_key_large) - 1 == 127);
+
+         const auto* small = reinterpret_cast<const uint8_t*>(test_key_small);
+         const auto* large = reinterpret_cast<const uint8_t*>(test_key_large);
+         constexpr size_t small_size = sizeof(test_key_small) - 1;
+         constexpr size_t large_size = sizeof(test_key_large) - 1;
+
+         // TEST INITIALIZERS
+
+         const __m128i initialize_0 = _mm_setzero_si128();
+         const __m128i initialize_1 = _mm_set1_epi64x(std::numeric_limits<uint64_t>::max());
+
+         // TEST VECTOR HASHES
+
+         // Hash(test_key_small, 31, initialize_0)
+         const uint8_t valid_31_0[] = {0x4E, 0xF7, 0x44, 0xCA, 0xC8, 0x10, 0xCB, 0x77,
+                                       0x90, 0xD7, 0x9E, 0xDB, 0x0E, 0x6E, 0xBE, 0x9B};
+         // Hash(test_key_small, 31, initialize_1)
+         const uint8_t valid_31_1[] = {0x30, 0xE9, 0xEF, 0xE4, 0x6B, 0x5C, 0x05, 0x2E,
+                                       0xED, 0x62, 0xE3, 0xA4, 0x90, 0x77, 0x46, 0x01};
+
+         // Hash(test_key_large, 127, initialize_0)
+         const uint8_t valid_127_0[] = {0x7A, 0x39, 0xDA, 0xDC, 0x21, 0x50, 0xFB, 0xF2,
+                                        0x78, 0x92, 0xC1, 0x1C, 0x25, 0xAA, 0x03, 0x4E};
+         // Hash(test_key_large, 127, initialize_1)
+         const uint8_t valid_127_1[] = {0x0E, 0xDD, 0x5A, 0x3A, 0xB7, 0x4B, 0xFA, 0xC3,
+                                        0xFF, 0x73, 0x84, 0xA2, 0x8B, 0xB9, 0xBF, 0x13};
+
+         // small and large key algorithm tests with both initializers
+         {
+            __m128i hash = SmallKeyAlgorithm(small, small_size, initialize_0);
+            if (std::memcmp(&hash, &valid_31_0, sizeof(hash)))
+               return __LINE__;
+
+            hash = SmallKeyAlgorithm(small, small_size, initialize_1);
+            if (std::memcmp(&hash, &valid_31_1, sizeof(hash)))
+               return __LINE__;
+
+            hash = LargeKeyAlgorithm(large, large_size, initialize_0);
+            if (std::memcmp(&hash, &valid_127_0, sizeof(hash)))
+               return __LINE__;
+
+            hash = LargeKeyAlgorithm(large, large_size, initialize_1);
+            if (std::memcmp(&hash, &valid_127_1, sizeof(hash)))
+               return __LINE__;
+         }
+
+         // make sure hybrid algorithm matches underlying algorithm components
+         {
+            __m128i hash = Hash(small, small_size, initialize_0);
+            if (std::memcmp(&hash, &valid_31_0, sizeof(hash)))
+               return __LINE__;
+
+            hash = Hash(small, small_size, initialize_1);
+            if (std::memcmp(&hash, &valid_31_1, sizeof(hash)))
+               return __LINE__;
+
+            hash = Hash(large, large_size, initialize_0);
+            if (std::memcmp(&hash, &valid_127_0, sizeof(hash)))
+               return __LINE__;
+
+            hash = Hash(large, large_size, initialize_1);
+            if (std::memcmp(&hash, &valid_127_1, sizeof(hash)))
+               return __LINE__;
+         }
+
+         // verify incremental algorithm against non-incremental algorithms
+         {
+            // incremental on small key one-shot
+            {
+               AquaHash aqua(initialize_1);
+               aqua.Update(small, small_size);
+               const __m128i hash = aqua.Finalize();
+               if (std::memcmp(&hash, &valid_31_1, sizeof(hash)))
+                  return __LINE__;
+            }
+
+            // incremental using every possible chunk size across block boundary
+            for (size_t span = 1; span <= large_size; span++) {
+               AquaHash aqua(initialize_0);
+               const size_t div = large_size / span;
+               const size_t mod = large_size % span;
+               for (size_t j = 0; j < div; j++)
+                  aqua.Update(large + j * span, span);
+               aqua.Update(large + large_size - mod, mod);
+               const __m128i hash = aqua.Finalize();
+               if (std::memcmp(&hash, &valid_127_0, sizeof(hash)))
+                  return __LINE__;
+            }
+
+            // incremental against hybrid on every prefix, i.e., every possible remainder
+            AquaHash aqua;
+            for (size_t bytes = 0; bytes <= large_size; bytes++) {
+               aqua.Initialize(initialize_1);
+               aqua.Update(large, bytes / 2);
+               aqua.Update(large + bytes / 2, bytes - bytes / 2);
+               const __m128i hash = aqua.Finalize();
+               const __m128i expected = Hash(large, bytes, initialize_1);
+               if (std::memcmp(&hash, &expected, sizeof(hash)))
+                  return __LINE__;
+            }
+         }
+
+         return 0;
+      }
+
      private:
       // INCREMENTAL CONSTRUCTION STATE
 
@@ -258,13 +563,15 @@ namespace hashing {
       __m128i initialize;
       // cumulative input bytes
       size_t input_bytes;
+      // seed of the one-shot operator()
+      __m128i seed;
 
       static constexpr size_t max_input = std::numeric_limits<size_t>::max() - 1;
       // sentinel to prevent double finalization
       static constexpr size_t finalized = max_input + 1;
 
       // Reference implementation of AquaHash small key algorithm
-      static __m128i SmallKeyAlgorithm(const uint8_t* key, const size_t bytes,
+      static target_sse42aes __m128i SmallKeyAlgorithm(const uint8_t* key, const size_t bytes,
                                        __m128i initialize = _mm_setzero_si128()) {
          assert(bytes <= max_input);
          __m128i hash = initialize;
@@ -314,376 +621,154 @@ namespace hashing {
          return _mm_aesenc_si128(hash, _mm_set_epi64x(0xd2600de7157abc68, 0x6339e901c3031efb));
       }
 
-      //   // Reference implementation of AquaHash large key algorithm
-      //   static __m128i LargeKeyAlgorithm(const uint8_t* key, const size_t bytes, __m128i initialize = _mm_setzero_si128()) {
-      //      assert(bytes <= max_input);
-      //
-      //      // initialize 4 x 128-bit hashing lanes, for a 512-bit block size
-      //      __m128i block[4] = {_mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b)),
-      //                          _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69)),
-      //                          _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e)),
-      //                          _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a))};
-      //
-      //      // bulk hashing loop -- 512-bit block size
-      //      const __m128i* ptr128 = reinterpret_cast<const __m128i*>(key);
-      //      for (size_t block_counter = 0; block_counter < bytes / sizeof(block); block_counter++) {
-      //         block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
-      //         block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
-      //         block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
-      //         block[3] = _mm_aesenc_si128(block[3], _mm_loadu_si128(ptr128++));
-      //      }
-      //
-      //      // process remaining AES blocks
-      //      if (bytes & 32) {
-      //         block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
-      //         block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
-      //      }
-      //
-      //      if (bytes & 16) {
-      //         block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
-      //      }
-      //
-      //      // AES sub-block processor
-      //      const uint8_t* ptr8 = reinterpret_cast<const uint8_t*>(ptr128);
-      //      if (bytes & 8) {
-      //         __m128i b = _mm_set_epi64x(*reinterpret_cast<const uint64_t*>(ptr8), 0xa11202c9b468bea1);
-      //         block[3] = _mm_aesenc_si128(block[3], b);
-      //         ptr8 += 8;
-      //      }
-      //
-      //      if (bytes & 4) {
-      //         __m128i b = _mm_set_epi32(0xb1293b33, 0x05418592, *reinterpret_cast<const uint32_t*>(ptr8), 0xd210d232);
-      //         block[0] = _mm_aesenc_si128(block[0], b);
-      //         ptr8 += 4;
-      //      }
-      //
-      //      if (bytes & 2) {
-      //         __m128i b = _mm_set_epi16(0xbd3d, 0xc2b7, 0xb87c, 0x4715, 0x6a6c, 0x9527,
-      //                                   *reinterpret_cast<const uint16_t*>(ptr8), 0xac2e);
-      //         block[1] = _mm_aesenc_si128(block[1], b);
-      //         ptr8 += 2;
-      //      }
-      //
-      //      if (bytes & 1) {
-      //         __m128i b = _mm_set_epi8(0xcc, 0x96, 0xed, 0x16, 0x74, 0xea, 0xaa, 0x03, 0x1e, 0x86, 0x3f, 0x24, 0xb2, 0xa8,
-      //                                  *ptr8, 0x31);
-      //         block[2] = _mm_aesenc_si128(block[2], b);
-      //      }
-      //
-      //      // indirectly mix hashing lanes
-      //      const __m128i mix = _mm_xor_si128(_mm_xor_si128(block[0], block[1]), _mm_xor_si128(block[2], block[3]));
-      //      block[0] = _mm_aesenc_si128(block[0], mix);
-      //      block[1] = _mm_aesenc_si128(block[1], mix);
-      //      block[2] = _mm_aesenc_si128(block[2], mix);
-      //      block[3] = _mm_aesenc_si128(block[3], mix);
-      //
-      //      // reduction from 512-bit block size to 128-bit hash
-      //      __m128i hash = _mm_aesenc_si128(_mm_aesenc_si128(block[0], block[1]), _mm_aesenc_si128(block[2], block[3]));
-      //
-      //      // this algorithm construction requires no less than one round to finalize
-      //      return _mm_aesenc_si128(hash, _mm_set_epi64x(0x8e51ef21fabb4522, 0xe43d7a0656954b6c));
-      //   }
+      // Reference implementation of AquaHash large key algorithm
+      static target_sse42aes __m128i LargeKeyAlgorithm(const uint8_t* key, const size_t bytes,
+                                                       __m128i initialize = _mm_setzero_si128()) {
+         assert(bytes <= max_input);
+
+         // initialize 4 x 128-bit hashing lanes, for a 512-bit block size
+         __m128i block[4] = {_mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b)),
+                             _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69)),
+                             _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e)),
+                             _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a))};
+
+         // bulk hashing loop -- 512-bit block size
+         const __m128i* ptr128 = reinterpret_cast<const __m128i*>(key);
+         for (size_t block_counter = 0; block_counter < bytes / sizeof(block); block_counter++) {
+            block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
+            block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
+            block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
+            block[3] = _mm_aesenc_si128(block[3], _mm_loadu_si128(ptr128++));
+         }
+
+         // process remaining AES blocks
+         if (bytes & 32) {
+            block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
+            block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
+         }
+
+         if (bytes & 16) {
+            block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
+         }
+
+         // AES sub-block processor
+         const uint8_t* ptr8 = reinterpret_cast<const uint8_t*>(ptr128);
+         if (bytes & 8) {
+            __m128i b = _mm_set_epi64x(*reinterpret_cast<const uint64_t*>(ptr8), 0xa11202c9b468bea1);
+            block[3] = _mm_aesenc_si128(block[3], b);
+            ptr8 += 8;
+         }
+
+         if (bytes & 4) {
+            __m128i b = _mm_set_epi32(0xb1293b33, 0x05418592, *reinterpret_cast<const uint32_t*>(ptr8), 0xd210d232);
+            block[0] = _mm_aesenc_si128(block[0], b);
+            ptr8 += 4;
+         }
+
+         if (bytes & 2) {
+            __m128i b = _mm_set_epi16(0xbd3d, 0xc2b7, 0xb87c, 0x4715, 0x6a6c, 0x9527,
+                                      *reinterpret_cast<const uint16_t*>(ptr8), 0xac2e);
+            block[1] = _mm_aesenc_si128(block[1], b);
+            ptr8 += 2;
+         }
+
+         if (bytes & 1) {
+            __m128i b = _mm_set_epi8(0xcc, 0x96, 0xed, 0x16, 0x74, 0xea, 0xaa, 0x03, 0x1e, 0x86, 0x3f, 0x24, 0xb2, 0xa8,
+                                     *ptr8, 0x31);
+            block[2] = _mm_aesenc_si128(block[2], b);
+         }
+
+         // indirectly mix hashing lanes
+         const __m128i mix = _mm_xor_si128(_mm_xor_si128(block[0], block[1]), _mm_xor_si128(block[2], block[3]));
+         block[0] = _mm_aesenc_si128(block[0], mix);
+         block[1] = _mm_aesenc_si128(block[1], mix);
+         block[2] = _mm_aesenc_si128(block[2], mix);
+         block[3] = _mm_aesenc_si128(block[3], mix);
+
+         // reduction from 512-bit block size to 128-bit hash
+         __m128i hash = _mm_aesenc_si128(_mm_aesenc_si128(block[0], block[1]), _mm_aesenc_si128(block[2], block[3]));
+
+         // this algorithm construction requires no less than one round to finalize
+         return _mm_aesenc_si128(hash, _mm_set_epi64x(0x8e51ef21fabb4522, 0xe43d7a0656954b6c));
+      }
+
+      /**
+       * @return the select-th 32 or 64 bits of hash for 32 and 64-bit T, the full hash for 128-bit T
+       */
+      static forceinline T extract(const __m128i& hash) {
+         if constexpr (sizeof(T) == sizeof(HASH_32)) {
+            return hashing::reduction::extract_32<select>(hash);
+         } else if constexpr (sizeof(T) == sizeof(HASH_64)) {
+            return hashing::reduction::extract_64<select>(hash);
+         } else {
+            static_assert(sizeof(T) == sizeof(HASH_128), "aqua hashes are at most 128 bits wide");
+            return to_hash128(hashing::reduction::extract_64<1>(hash), hashing::reduction::extract_64<0>(hash));
+         }
+      }
 
       // NON-INCREMENTAL HYBRID ALGORITHM
 
-      static forceinline __m128i Hash(const uint8_t* key, const size_t bytes,
+      static forceinline_sse42aes __m128i Hash(const uint8_t* key, const size_t bytes,
                                       __m128i initialize = _mm_setzero_si128()) {
-         assert(bytes < 64);
-         return SmallKeyAlgorithm(key, bytes, initialize);
-         //      return bytes < 64 ? SmallKeyAlgorithm(key, bytes, initialize) : LargeKeyAlgorithm(key, bytes, initialize);
+         return bytes < 64 ? SmallKeyAlgorithm(key, bytes, initialize) : LargeKeyAlgorithm(key, bytes, initialize);
       }
+   };
 
-      //   // INCREMENTAL HYBRID ALGORITHM
-      //
-      //   // Initialize a new incremental hashing object
-      //   AquaHash(const __m128i initialize = _mm_setzero_si128())
-      //      : block{_mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b)),
-      //              _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69)),
-      //              _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e)),
-      //              _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a))},
-      //        initialize(initialize), input_bytes(0) {}
-      //
-      //   // Initialize an existing hashing object -- all previous state is destroyed
-      //   void Initialize(const __m128i initialize = _mm_setzero_si128()) {
-      //      this->initialize = initialize;
-      //      this->input_bytes = 0;
-      //      block[0] = _mm_xor_si128(initialize, _mm_set_epi64x(0xa11202c9b468bea1, 0xd75157a01452495b));
-      //      block[1] = _mm_xor_si128(initialize, _mm_set_epi64x(0xb1293b3305418592, 0xd210d232c6429b69));
-      //      block[2] = _mm_xor_si128(initialize, _mm_set_epi64x(0xbd3dc2b7b87c4715, 0x6a6c9527ac2e0e4e));
-      //      block[3] = _mm_xor_si128(initialize, _mm_set_epi64x(0xcc96ed1674eaaa03, 0x1e863f24b2a8316a));
-      //   }
-      //
-      //   // Append key to existing hashing object state
-      //   void Update(const uint8_t* key, size_t bytes) {
-      //      assert(input_bytes != finalized);
-      //      assert(bytes <= max_input && max_input - input_bytes >= bytes);
-      //
-      //      if (bytes == 0)
-      //         return;
-      //
-      //      // input buffer may be partially filled
-      //      if (input_bytes % sizeof(input)) {
-      //         // pointer to first unused byte in input buffer
-      //         uint8_t* ptr8 = reinterpret_cast<uint8_t*>(input) + (input_bytes % sizeof(input));
-      //
-      //         // compute initial copy size from key to input buffer
-      //         size_t copy_size = sizeof(input) - (input_bytes % sizeof(input));
-      //         if (copy_size > bytes)
-      //            copy_size = bytes;
-      //
-      //         // append new key bytes to input buffer
-      //         memcpy(ptr8, key, copy_size);
-      //         input_bytes += copy_size;
-      //         bytes -= copy_size;
-      //
-      //         // input buffer not filled by update
-      //         if (input_bytes % sizeof(input))
-      //            return;
-      //
-      //         // update key pointer to first byte not in the input buffer
-      //         key += copy_size;
-      //
-      //         // hash input buffer
-      //         block[0] = _mm_aesenc_si128(block[0], input[0]);
-      //         block[1] = _mm_aesenc_si128(block[1], input[1]);
-      //         block[2] = _mm_aesenc_si128(block[2], input[2]);
-      //         block[3] = _mm_aesenc_si128(block[3], input[3]);
-      //      }
-      //
-      //      input_bytes += bytes;
-      //
-      //      // input buffer is empty
-      //      const __m128i* ptr128 = reinterpret_cast<const __m128i*>(key);
-      //      while (bytes >= sizeof(block)) {
-      //         block[0] = _mm_aesenc_si128(block[0], _mm_loadu_si128(ptr128++));
-      //         block[1] = _mm_aesenc_si128(block[1], _mm_loadu_si128(ptr128++));
-      //         block[2] = _mm_aesenc_si128(block[2], _mm_loadu_si128(ptr128++));
-      //         block[3] = _mm_aesenc_si128(block[3], _mm_loadu_si128(ptr128++));
-      //         bytes -= sizeof(block);
-      //      }
-      //
-      //      // load remaining bytes into input buffer
-      //      if (bytes)
-      //         memcpy(input, ptr128, bytes);
-      //   }
+   /**
+    * Streaming interface on top of AquaHash's incremental construction. The digest is
+    * identical to AquaHash<HASH_64> (HASH_64) or to the full 128-bit hash (HASH_128) of
+    * the concatenated input
+    *
+    * @tparam Result digest type, either HASH_64 or HASH_128
+    */
+   template<class Result = HASH_64>
+   struct AquaHashStream {
+      static_assert(std::is_same_v<Result, HASH_64> || std::is_same_v<Result, HASH_128>,
+                    "aqua digests are either 64 or 128 bits wide");
 
-      //   // Generate hash from hashing object state. After finalization, the hashing
-      //   // object is in an undefined state and must be initialized before any
-      //   // subsequent calls on the object.
-      //   __m128i Finalize() {
-      //      assert(input_bytes != finalized);
-      //      if (input_bytes < sizeof(block)) {
-      //         __m128i hash = SmallKeyAlgorithm(reinterpret_cast<uint8_t*>(input), input_bytes, initialize);
-      //         input_bytes = finalized;
-      //         return hash;
-      //      } else {
-      //         // process remaining AES blocks
-      //         if (input_bytes & 32) {
-      //            block[0] = _mm_aesenc_si128(block[0], input[0]);
-      //            block[1] = _mm_aesenc_si128(block[1], input[1]);
-      //         }
-      //
-      //         if (input_bytes & 16) {
-      //            block[2] = _mm_aesenc_si128(block[2], input[2]);
-      //         }
-      //
-      //         // AES sub-block processor
-      //         const uint8_t* ptr8 = reinterpret_cast<const uint8_t*>(&input[3]);
-      //         if (input_bytes & 8) {
-      //            __m128i b = _mm_set_epi64x(*reinterpret_cast<const uint64_t*>(ptr8), 0xa11202c9b468bea1);
-      //            block[3] = _mm_aesenc_si128(block[3], b);
-      //            ptr8 += 8;
-      //         }
-      //
-      //         if (input_bytes & 4) {
-      //            __m128i b = _mm_set_epi32(0xb1293b33, 0x05418592, *reinterpret_cast<const uint32_t*>(ptr8), 0xd210d232);
-      //            block[0] = _mm_aesenc_si128(block[0], b);
-      //            ptr8 += 4;
-      //         }
-      //
-      //         if (input_bytes & 2) {
-      //            __m128i b = _mm_set_epi16(0xbd3d, 0xc2b7, 0xb87c, 0x4715, 0x6a6c, 0x9527,
-      //                                      *reinterpret_cast<const uint16_t*>(ptr8), 0xac2e);
-      //            block[1] = _mm_aesenc_si128(block[1], b);
-      //            ptr8 += 2;
-      //         }
-      //
-      //         if (input_bytes & 1) {
-      //            __m128i b = _mm_set_epi8(0xcc, 0x96, 0xed, 0x16, 0x74, 0xea, 0xaa, 0x03, 0x1e, 0x86, 0x3f, 0x24, 0xb2, 0xa8,
-      //                                     *ptr8, 0x31);
-      //            block[2] = _mm_aesenc_si128(block[2], b);
-      //         }
-      //
-      //         // indirectly mix hashing lanes
-      //         const __m128i mix = _mm_xor_si128(_mm_xor_si128(block[0], block[1]), _mm_xor_si128(block[2], block[3]));
-      //         block[0] = _mm_aesenc_si128(block[0], mix);
-      //         block[1] = _mm_aesenc_si128(block[1], mix);
-      //         block[2] = _mm_aesenc_si128(block[2], mix);
-      //         block[3] = _mm_aesenc_si128(block[3], mix);
-      //
-      //         // reduction from 512-bit block size to 128-bit hash
-      //         __m128i hash = _mm_aesenc_si128(_mm_aesenc_si128(block[0], block[1]), _mm_aesenc_si128(block[2], block[3]));
-      //
-      //         // this algorithm construction requires no less than 1 round to finalize
-      //         input_bytes = finalized;
-      //         return _mm_aesenc_si128(hash, _mm_set_epi64x(0x8e51ef21fabb4522, 0xe43d7a0656954b6c));
-      //      }
-      //   }
-   };
+      /// requires AES-NI, may only be executed if dispatch::supported<AquaHashStream>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
 
-   template<>
-   HASH_32 AquaHash<HASH_32, 0>::operator()(const HASH_32& value, const __m128i seed) const {
-      return hashing::reduction::extract_32<0>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_32), seed));
-   }
-   template<>
-   HASH_32 AquaHash<HASH_32, 1>::operator()(const HASH_32& value, const __m128i seed) const {
-      return hashing::reduction::extract_32<1>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_32), seed));
-   }
-   template<>
-   HASH_32 AquaHash<HASH_32, 2>::operator()(const HASH_32& value, const __m128i seed) const {
-      return hashing::reduction::extract_32<2>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_32), seed));
-   }
-   template<>
-   HASH_32 AquaHash<HASH_32, 3>::operator()(const HASH_32& value, const __m128i seed) const {
-      return hashing::reduction::extract_32<3>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_32), seed));
-   }
-
-   template<>
-   HASH_64 AquaHash<HASH_64, 0>::operator()(const HASH_64& value, const __m128i seed) const {
-      return hashing::reduction::extract_64<0>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_64), seed));
-   }
-   template<>
-   HASH_64 AquaHash<HASH_64, 1>::operator()(const HASH_64& value, const __m128i seed) const {
-      return hashing::reduction::extract_64<1>(Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(HASH_64), seed));
-   }
-
-   /// TEST CODE
-   //// Verifies the implementation matches test vectors computed several ways.
-   //// Returns zero on success or line number on test failure.
-   //static int VerifyImplementation() {
-   //   // A 31-byte string is the smallest key that will exercise all hash
-   //   // computation branches in the small key algorithm
-   //   static constexpr char test_key_small[] = "0123456789012345678901234567890";
-   //   assert(strlen(test_key_small) == 31);
-   //
-   //   // A 127-byte string is the smallest key that will exercise all hash
-   //   // computation branches in the large key algorithm
-   //   static constexpr char test_key_large[] = "01234567890123456789012345678901"
-   //                                            "23456789012345678901234567890123"
-   //                                            "45678901234567890123456789012345"
-   //                                            "6789012345678901234567890123456";
-   //   assert(strlen(test_key_large) == 127);
-   //
-   //   // TEST INITIALIZERS
-   //
-   //   const __m128i initialize_0 = _mm_setzero_si128();
-   //   const __m128i initialize_1 = _mm_set1_epi64x(std::numeric_limits<uint64_t>::max());
-   //
-   //   // TEST VECTOR HASHES
-   //
-   //   // Hash(test_key_small, 31, initialize_0)
-   //   const uint8_t valid_31_0[] = {0x4E, 0xF7, 0x44, 0xCA, 0xC8, 0x10, 0xCB, 0x77,
-   //                                 0x90, 0xD7, 0x9E, 0xDB, 0x0E, 0x6E, 0xBE, 0x9B};
-   //   // Hash(test_key_small, 31, initialize_1)
-   //   const uint8_t valid_31_1[] = {0x30, 0xE9, 0xEF, 0xE4, 0x6B, 0x5C, 0x05, 0x2E,
-   //                                 0xED, 0x62, 0xE3, 0xA4, 0x90, 0x77, 0x46, 0x01};
-   //
-   //   // Hash(test_key_large, 127, initialize_0)
-   //   const uint8_t valid_127_0[] = {0x7A, 0x39, 0xDA, 0xDC, 0x21, 0x50, 0xFB, 0xF2,
-   //                                  0x78, 0x92, 0xC1, 0x1C, 0x25, 0xAA, 0x03, 0x4E};
-   //   // Hash(test_key_large, 127, initialize_1)
-   //   const uint8_t valid_127_1[] = {0x0E, 0xDD, 0x5A, 0x3A, 0xB7, 0x4B, 0xFA, 0xC3,
-   //                                  0xFF, 0x73, 0x84, 0xA2, 0x8B, 0xB9, 0xBF, 0x13};
-   //
-   //   // small key algorithm test with first initializer
-   //   {
-   //      auto hash =
-   //         SmallKeyAlgorithm(reinterpret_cast<const uint8_t*>(test_key_small), strlen(test_key_small), initialize_0);
-   //      if (memcmp(&hash, &valid_31_0, sizeof(hash)))
-   //         return __LINE__;
-   //   }
-   //
-   //   // small key algorithm test with second initializer
-   //   {
-   //      auto hash =
-   //         SmallKeyAlgorithm(reinterpret_cast<const uint8_t*>(test_key_small), strlen(test_key_small), initialize_1);
-   //      if (memcmp(&hash, &valid_31_1, sizeof(hash)))
-   //         return __LINE__;
-   //   }
-   //
-   //   // large key algorithm test with first initializer
-   //   {
-   //      auto hash =
-   //         LargeKeyAlgorithm(reinterpret_cast<const uint8_t*>(test_key_large), strlen(test_key_large), initialize_0);
-   //      if (memcmp(&hash, &valid_127_0, sizeof(hash)))
-   //         return __LINE__;
-   //   }
-   //
-   //   // large key algorithm test with second initializer
-   //   {
-   //      auto hash =
-   //         LargeKeyAlgorithm(reinterpret_cast<const uint8_t*>(test_key_large), strlen(test_key_large), initialize_1);
-   //      if (memcmp(&hash, &valid_127_1, sizeof(hash)))
-   //         return __LINE__;
-   //   }
-   //
-   //   // make sure hybrid algorithm matches underlying algorithm components
-   //   {
-   //      __m128i hash;
-   //
-   //      hash = Hash(reinterpret_cast<const uint8_t*>(test_key_small), strlen(test_key_small), initialize_0);
-   //      if (memcmp(&hash, &valid_31_0, sizeof(hash)))
-   //         return __LINE__;
-   //
-   //      hash = Hash(reinterpret_cast<const uint8_t*>(test_key_small), strlen(test_key_small), initialize_1);
-   //      if (memcmp(&hash, &valid_31_1, sizeof(hash)))
-   //         return __LINE__;
-   //
-   //      hash = Hash(reinterpret_cast<const uint8_t*>(test_key_large), strlen(test_key_large), initialize_0);
-   //      if (memcmp(&hash, &valid_127_0, sizeof(hash)))
-   //         return __LINE__;
-   //
-   //      hash = Hash(reinterpret_cast<const uint8_t*>(test_key_large), strlen(test_key_large), initialize_1);
-   //      if (memcmp(&hash, &valid_127_1, sizeof(hash)))
-   //         return __LINE__;
-   //   }
-   //
-   //   // verify incremental algorithm against non-incremental algorithms
-   //   {
-   //      // incremental on small key one-shot
-   //      {
-   //         AquaHash aqua(initialize_0);
-   //         aqua.Update(reinterpret_cast<const uint8_t*>(test_key_small), strlen(test_key_small));
-   //         auto hash = aqua.Finalize();
-   //         if (memcmp(&hash, &valid_31_0, sizeof(hash)))
-   //            return __LINE__;
-   //      }
-   //
-   //      // incremental on large key one-shot
-   //      {
-   //         AquaHash aqua(initialize_0);
-   //         aqua.Update(reinterpret_cast<const uint8_t*>(test_key_large), strlen(test_key_large));
-   //         auto hash = aqua.Finalize();
-   //         if (memcmp(&hash, &valid_127_0, sizeof(hash)))
-   //            return __LINE__;
-   //      }
-   //
-   //      // incremental using every possible chunk size across block boundary
-   //      {
-   //         for (size_t span = 1; span <= strlen(test_key_large); span++) {
-   //            AquaHash aqua(initialize_0);
-   //            size_t div = strlen(test_key_large) / span;
-   //            size_t mod = strlen(test_key_large) % span;
-   //            for (size_t j = 0; j < div; j++)
-   //               aqua.Update(reinterpret_cast<const uint8_t*>(&test_key_large[j * span]), span);
-   //            aqua.Update(reinterpret_cast<const uint8_t*>(&test_key_large[strlen(test_key_large) - mod]), mod);
-   //            auto hash = aqua.Finalize();
-   //            if (memcmp(&hash, &valid_127_0, sizeof(hash)))
-   //               return __LINE__;
-   //         }
-   //      }
-   //   }
-   //
-   //   return 0;
-   //}
+      using Digest = Result;
+
+      static std::string name() {
+         return "aqua_stream_" + std::to_string(sizeof(Result) * 8);
+      }
+
+      explicit AquaHashStream(const __m128i seed = _mm_setzero_si128()) : seed(seed), aqua(seed) {}
+
+      /**
+       * discards all previously appended input
+       */
+      void reset() {
+         aqua.Initialize(seed);
+      }
+
+      forceinline_sse42aes void update(const void* data, const size_t& len) {
+         aqua.Update(reinterpret_cast<const uint8_t*>(data), len);
+      }
+
+      forceinline_sse42aes void update(const std::string_view& data) {
+         aqua.Update(data);
+      }
+
+      /**
+       * @return hash of all input appended since the last reset. Does not modify the state,
+       *    i.e., more input may be appended afterwards
+       */
+      target_sse42aes Digest digest() const {
+         // Finalize() invalidates the incremental state
+         auto copy = aqua;
+         const auto h = copy.Finalize();
+         if constexpr (std::is_same_v<Result, HASH_64>)
+            return reduction::extract_64<0>(h);
+         else
+            return static_cast<HASH_128>(reduction::extract_64<0>(h)) |
+               (static_cast<HASH_128>(reduction::extract_64<1>(h)) << 64);
+      }
+
+     private:
+      __m128i seed;
+      AquaHash<HASH_64> aqua;
+   };
 } // namespace hashing
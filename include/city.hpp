@@ -53,9 +53,11 @@
 #include <algorithm>
 #include <cstring> // for memcpy and memset
 #include <string>
+#include <string_view>
 #include <nmmintrin.h>
 
 #include "./convenience/builtins.hpp"
+#include "./dispatch.hpp"
 #include "./reduction.hpp"
 
 #ifdef _MSC_VER
@@ -342,7 +344,7 @@ namespace hashing {
       }
 
       // Requires len >= 240.
-      static forceinline void CityHashCrc256Long(const char* s, size_t len, HASH_32 seed, HASH_64* result) {
+      static forceinline_sse42aes void CityHashCrc256Long(const char* s, size_t len, HASH_32 seed, HASH_64* result) {
          HASH_64 a = Fetch64(s + 56) + k0;
          HASH_64 b = Fetch64(s + 96) + k0;
          HASH_64 c = result[0] = HashLen16(b, len);
@@ -435,7 +437,7 @@ namespace hashing {
       }
 
       // Requires len < 240.
-      static forceinline void CityHashCrc256Short(const char* s, size_t len, HASH_64* result) {
+      static forceinline_sse42aes void CityHashCrc256Short(const char* s, size_t len, HASH_64* result) {
          char buf[240];
          memcpy(buf, s, len);
          memset(buf + len, 0, 240 - len);
@@ -519,9 +521,15 @@ namespace hashing {
       }
 
       forceinline HASH_32 operator()(const T& key) const {
-         auto* s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+         return hash(reinterpret_cast<const char*>(&key), sizeof(T));
+      }
+
+      forceinline HASH_32 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
 
+     private:
+      static forceinline HASH_32 hash(const char* s, size_t len) {
          if (len <= 24) {
             return len <= 12 ? (len <= 4 ? Hash32Len0to4(s, len) : Hash32Len5to12(s, len)) : Hash32Len13to24(s, len);
          }
@@ -599,10 +607,19 @@ namespace hashing {
          return "city64";
       }
 
+      /// sorting by length only pays for strings up to 16 bytes, see columnar::ColumnHasher
+      static constexpr size_t columnar_sort_length = 16;
+
       forceinline HASH_64 operator()(const T& key) const {
-         auto s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+         return hash(reinterpret_cast<const char*>(&key), sizeof(T));
+      }
+
+      forceinline HASH_64 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
 
+     private:
+      static forceinline HASH_64 hash(const char* s, size_t len) {
          if (len <= 32) {
             if (len <= 16) {
                return HashLen0to16(s, len);
@@ -642,41 +659,60 @@ namespace hashing {
    };
 
    /**
- * CityHash64 with a seed
- * @tparam T
- * @tparam seed
- */
-   template<class T, const HASH_64 seed>
+    * CityHash64 with a seed, equivalent to the reference CityHash64WithSeed
+    *
+    * @tparam T
+    * @tparam default_seed seed of default constructed instances. name() reports this seed
+    */
+   template<class T, const HASH_64 default_seed = 0>
    struct CityHash64Seed : private CityHash {
       static std::string name() {
-         return "city64_seed_" + std::to_string(seed);
+         return "city64_seed_" + std::to_string(default_seed);
       }
 
+      explicit CityHash64Seed(const HASH_64& seed = default_seed) : seed(seed) {}
+
       forceinline HASH_64 operator()(const T& key) const {
-         return HashLen16(this(key) - k2, seed);
+         return HashLen16(hash(key) - k2, seed);
+      }
+
+      forceinline HASH_64 operator()(const std::string_view& key) const {
+         return HashLen16(hash(key) - k2, seed);
       }
 
      private:
-      const CityHash64<T> hash;
+      HASH_64 seed;
+      CityHash64<T> hash;
    };
 
    /**
- * CityHash64 with two seeds
- * @tparam T
- * @tparam seed
- */
-   template<class T, const HASH_64 seed0, const HASH_64 seed1>
+    * CityHash64 with two seeds, equivalent to the reference CityHash64WithSeeds
+    *
+    * @tparam T
+    * @tparam default_seed0 first seed of default constructed instances. name() reports this seed
+    * @tparam default_seed1 second seed of default constructed instances. name() reports this seed
+    */
+   template<class T, const HASH_64 default_seed0 = 0, const HASH_64 default_seed1 = 0>
    struct CityHash64Seeds : private CityHash {
       static std::string name() {
-         return "city64_seeds_" + std::to_string(seed0) + "_" + std::to_string(seed1);
+         return "city64_seeds_" + std::to_string(default_seed0) + "_" + std::to_string(default_seed1);
       }
 
+      explicit CityHash64Seeds(const HASH_64& seed0 = default_seed0, const HASH_64& seed1 = default_seed1)
+         : seed0(seed0), seed1(seed1) {}
+
       forceinline HASH_64 operator()(const T& key) const {
-         return HashLen16(this(key) - seed0, seed1);
+         return HashLen16(hash(key) - seed0, seed1);
+      }
+
+      forceinline HASH_64 operator()(const std::string_view& key) const {
+         return HashLen16(hash(key) - seed0, seed1);
       }
 
      private:
-      const CityHash64<T> hash;
+      HASH_64 seed0;
+      HASH_64 seed1;
+      CityHash64<T> hash;
    };
 
    /**
@@ -690,35 +726,45 @@ namespace hashing {
       }
 
       forceinline HASH_128 operator()(const T& key) const {
-         const auto* s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+         return hash(reinterpret_cast<const char*>(&key), sizeof(T));
+      }
 
+      forceinline HASH_128 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
+
+     private:
+      static forceinline HASH_128 hash(const char* s, size_t len) {
          return len >= 16 ? CityHash128WithSeed(s + 16, len - 16, to_hash128(Fetch64(s), Fetch64(s + 8) + k0)) :
                             CityHash128WithSeed(s, len, to_hash128(k0, k1));
       }
    };
 
    /**
- * CityHash128 with a seed
- * @tparam T
- * @tparam seed
- */
-   template<class T, const HASH_128 seed>
+    * CityHash128 with a seed, equivalent to the reference CityHash128WithSeed
+    *
+    * @tparam T
+    * @tparam default_seed seed of default constructed instances. name() reports this seed
+    */
+   template<class T, const HASH_128 default_seed = 0>
    struct CityHash128Seed : private CityHash {
       static std::string name() {
-         return "city128_seed_h" + std::to_string(reduction::higher(seed)) + "_l" +
-            std::to_string(reduction::lower(seed));
+         return "city128_seed_h" + std::to_string(reduction::higher(default_seed)) + "_l" +
+            std::to_string(reduction::lower(default_seed));
       }
 
-      forceinline HASH_64 operator()(const T& key) const {
-         const auto* s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+      explicit CityHash128Seed(const HASH_128& seed = default_seed) : seed(seed) {}
+
+      forceinline HASH_128 operator()(const T& key) const {
+         return CityHash128WithSeed(reinterpret_cast<const char*>(&key), sizeof(T), seed);
+      }
 
-         return CityHash128WithSeed(s, len, seed);
+      forceinline HASH_128 operator()(const std::string_view& key) const {
+         return CityHash128WithSeed(key.data(), key.size(), seed);
       }
 
      private:
-      const CityHash64<T> hash;
+      HASH_128 seed;
    };
 
    /**
@@ -731,10 +777,19 @@ namespace hashing {
          return "city_crc256";
       }
 
-      forceinline HASH_256 operator()(const T& key) const {
-         const auto* s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+      /// requires SSE4.2 crc32, may only be executed if dispatch::supported<CityHashCrc256>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
 
+      forceinline_sse42aes HASH_256 operator()(const T& key) const {
+         return hash(reinterpret_cast<const char*>(&key), sizeof(T));
+      }
+
+      forceinline_sse42aes HASH_256 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
+
+     private:
+      static forceinline_sse42aes HASH_256 hash(const char* s, size_t len) {
          HASH_256 result;
          if (likely(len >= 240)) {
             CityHashCrc256Long(s, len, 0, reinterpret_cast<uint64_t*>(&result));
@@ -756,10 +811,20 @@ namespace hashing {
          return "city_crc128";
       }
 
-      forceinline HASH_128 operator()(const T& key) {
-         size_t len = sizeof(T);
+      /// requires SSE4.2 crc32 for keys longer than 900 bytes
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      forceinline_sse42aes HASH_128 operator()(const T& key) const {
+         return hash(std::string_view(reinterpret_cast<const char*>(&key), sizeof(T)));
+      }
+
+      forceinline_sse42aes HASH_128 operator()(const std::string_view& key) const {
+         return hash(key);
+      }
 
-         if (len <= 900) {
+     private:
+      static forceinline_sse42aes HASH_128 hash(const std::string_view& key) {
+         if (key.size() <= 900) {
             CityHash128<T> hash;
             return hash(key);
          } else {
@@ -771,23 +836,37 @@ namespace hashing {
    };
 
    /**
- * CityHashCrc128 with a seed
- * @tparam T
- * @tparam seed
- */
-   template<class T, HASH_128 seed>
+    * CityHashCrc128 with a seed, equivalent to the reference CityHashCrc128WithSeed
+    *
+    * @tparam T
+    * @tparam default_seed seed of default constructed instances. name() reports this seed
+    */
+   template<class T, const HASH_128 default_seed = 0>
    struct CityHashCrc128Seed : private CityHash {
       static std::string name() {
-         return "city_crc128_seed_h" + std::to_string(reduction::higher(seed)) + "_l" +
-            std::to_string(reduction::lower(seed));
+         return "city_crc128_seed_h" + std::to_string(reduction::higher(default_seed)) + "_l" +
+            std::to_string(reduction::lower(default_seed));
       }
 
-      forceinline HASH_128 operator()(const T& key) {
-         const auto* s = reinterpret_cast<const char*>(&key);
-         size_t len = sizeof(T);
+      /// requires SSE4.2 crc32 for keys longer than 900 bytes
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      explicit CityHashCrc128Seed(const HASH_128& seed = default_seed) : seed(seed) {}
+
+      forceinline_sse42aes HASH_128 operator()(const T& key) const {
+         return hash(std::string_view(reinterpret_cast<const char*>(&key), sizeof(T)));
+      }
+
+      forceinline_sse42aes HASH_128 operator()(const std::string_view& key) const {
+         return hash(key);
+      }
+
+     private:
+      HASH_128 seed;
 
-         if (len <= 900) {
-            return CityHash128WithSeed(s, len, seed);
+      forceinline_sse42aes HASH_128 hash(const std::string_view& key) const {
+         if (key.size() <= 900) {
+            return CityHash128WithSeed(key.data(), key.size(), seed);
          } else {
             CityHashCrc256<T> hash;
             auto result = hash(key);
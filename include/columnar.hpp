@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "dispatch.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::columnar {
+   /**
+    * Strings are grouped into length classes [0, 3], (3, 8], (8, 16], (16, 32], (32, 64]
+    * and (64, inf). The bounds coincide with the length branches of XXHash3 and CityHash64
+    * for short strings and with AquaHash's switch to its large key algorithm at 64 bytes.
+    * Within the classes up to 64 bytes, strings are additionally ordered by exact length
+    */
+   static constexpr std::array<size_t, 7> ClassBounds{0, 3, 8, 16, 32, 64, std::numeric_limits<size_t>::max()};
+   static constexpr size_t NumClasses = ClassBounds.size() - 1;
+
+   /**
+    * Blocks are only sorted by length if most of their strings are at most this long and
+    * hashed in input order otherwise. Declared via a static columnar_sort_length member by
+    * functions whose branches on longer strings are cheap enough that sorting costs more
+    * than it saves (e.g., XXHash3). Defaults to sorting all blocks
+    */
+   template<class Hashfn>
+   constexpr size_t sort_length() {
+      if constexpr (requires { Hashfn::columnar_sort_length; })
+         return Hashfn::columnar_sort_length;
+      return std::numeric_limits<size_t>::max();
+   }
+
+   namespace _ {
+      /// amount of strings sorted at once. Index lists of a block stay in L1
+      static constexpr size_t BlockSize = 1024;
+      /// amount of independent strings hashed per loop iteration
+      static constexpr size_t Interleave = 4;
+      /// distance of strings sampled to decide whether a block is sorted
+      static constexpr size_t SampleStride = 16;
+
+      /**
+       * hashes all strings of a single length class. Since their length is known to be within
+       * the class bounds, length branches of the (inlined) hash function that can not be taken are
+       * eliminated at compile time. Interleaving independent strings allows the cpu to overlap
+       * their dependency chains
+       */
+      template<size_t Class, class Hashfn, class Offset>
+      forceinline auto hash_one(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t& i) {
+         constexpr size_t Min = Class == 0 ? 0 : ClassBounds[Class] + 1;
+         constexpr size_t Max = ClassBounds[Class + 1];
+
+         const size_t len = static_cast<size_t>(offsets[i + 1] - offsets[i]);
+         assumeit(len >= Min && len <= Max);
+         return hashfn(std::string_view(bytes + offsets[i], len));
+      }
+
+      template<size_t Class, class Hashfn, class Offset, class Result>
+      forceinline void hash_class(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t base,
+                                  const std::uint16_t* indices, const size_t cnt, Result* out) {
+         size_t j = 0;
+         for (; j + Interleave <= cnt; j += Interleave) {
+            std::array<Result, Interleave> hashes;
+            for (size_t l = 0; l < Interleave; l++)
+               hashes[l] = hash_one<Class>(hashfn, offsets, bytes, base + indices[j + l]);
+            for (size_t l = 0; l < Interleave; l++)
+               out[base + indices[j + l]] = hashes[l];
+         }
+         for (; j < cnt; j++)
+            out[base + indices[j]] = hash_one<Class>(hashfn, offsets, bytes, base + indices[j]);
+      }
+
+      template<class Hashfn, class Offset, class Result, size_t... Class>
+      forceinline void hash_classes(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t base,
+                                    const std::array<std::uint16_t, BlockSize>& indices,
+                                    const std::array<std::uint16_t, NumClasses + 1>& class_starts, Result* out,
+                                    std::index_sequence<Class...>) {
+         (hash_class<Class>(hashfn, offsets, bytes, base, indices.data() + class_starts[Class],
+                            class_starts[Class + 1] - class_starts[Class], out),
+          ...);
+      }
+
+      /**
+       * hashes strings in ascending length order, which is established by a counting sort
+       * over exact lengths (one bucket per length up to the last class bound, one for all
+       * longer strings). Consecutive strings therefore take the same path through the hash
+       * function, making its length branches predictable even for lengths within a class
+       */
+      template<class Hashfn, class Offset, class Result>
+      forceinline void hash_columns(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t n,
+                                    Result* out) {
+         constexpr size_t Buckets = ClassBounds[NumClasses - 1] + 2;
+         constexpr size_t SortLength = sort_length<Hashfn>();
+         std::array<std::uint16_t, BlockSize> lengths;
+         std::array<std::uint16_t, BlockSize> indices;
+         std::array<std::uint16_t, Buckets + 1> starts;
+         std::array<std::uint16_t, NumClasses + 1> class_starts;
+
+         for (size_t base = 0; base < n; base += BlockSize) {
+            const size_t cnt = std::min(BlockSize, n - base);
+
+            // blocks of mostly longer strings are hashed in input order (see sort_length()),
+            // which is estimated from every SampleStride-th string
+            if constexpr (SortLength != std::numeric_limits<size_t>::max()) {
+               size_t short_cnt = 0, sampled = 0;
+               for (size_t i = base; i < base + cnt; i += SampleStride, sampled++)
+                  short_cnt += static_cast<size_t>(offsets[i + 1] - offsets[i]) <= SortLength;
+               if (2 * short_cnt < sampled) {
+                  for (size_t i = base; i < base + cnt; i++)
+                     out[i] = hashfn(
+                        std::string_view(bytes + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i])));
+                  continue;
+               }
+            }
+
+            std::fill(starts.begin(), starts.end(), 0);
+            for (size_t j = 0; j < cnt; j++) {
+               const size_t len = static_cast<size_t>(offsets[base + j + 1] - offsets[base + j]);
+               lengths[j] = static_cast<std::uint16_t>(std::min(len, Buckets - 1));
+               starts[lengths[j] + 1]++;
+            }
+            for (size_t b = 1; b <= Buckets; b++)
+               starts[b] += starts[b - 1];
+
+            class_starts[0] = 0;
+            for (size_t c = 1; c < NumClasses; c++)
+               class_starts[c] = starts[ClassBounds[c] + 1];
+            class_starts[NumClasses] = static_cast<std::uint16_t>(cnt);
+            for (size_t j = 0; j < cnt; j++)
+               indices[starts[lengths[j]]++] = static_cast<std::uint16_t>(j);
+
+            hash_classes(hashfn, offsets, bytes, base, indices, class_starts, out,
+                         std::make_index_sequence<NumClasses>{});
+         }
+      }
+
+      template<class Hashfn, class Offset, class Result>
+      void hash_scalar(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t n, Result* out) {
+         hash_columns(hashfn, offsets, bytes, n, out);
+      }
+
+      template<class Hashfn, class Offset, class Result>
+      target_sse42aes void hash_sse42aes(const Hashfn& hashfn, const Offset* offsets, const char* bytes,
+                                         const size_t n, Result* out) {
+         hash_columns(hashfn, offsets, bytes, n, out);
+      }
+
+      template<class Hashfn, class Offset, class Result>
+      target_avx2 void hash_avx2(const Hashfn& hashfn, const Offset* offsets, const char* bytes, const size_t n,
+                                 Result* out) {
+         hash_columns(hashfn, offsets, bytes, n, out);
+      }
+   } // namespace _
+
+   /**
+    * Hashes columnar string data, i.e., n strings stored back to back in a single byte buffer
+    * and delimited by n + 1 offsets (Arrow's string/large_string layout): string i spans
+    * bytes[offsets[i], offsets[i + 1]). Strings are hashed in blocks ordered by length
+    * instead of in input order, which avoids mispredicting the hash function's length
+    * branches on columns of mixed length. Like dispatch::BatchHasher, the kernel is compiled
+    * for the highest instruction set supported by the cpu.
+    *
+    * Sorting costs a few nanoseconds per string. It pays off for functions with many length
+    * dependent paths (e.g., AquaHash) and for columns of short, varying strings, but is
+    * slower than a plain loop for functions that hash longer strings (e.g., emails or urls)
+    * in a few nanoseconds. Those declare up to which length sorting pays (see sort_length()).
+    *
+    * @tparam Hashfn hash function providing operator()(std::string_view)
+    * @tparam Offset offset type, e.g., std::int32_t or std::int64_t
+    */
+   template<class Hashfn, class Offset = std::int32_t>
+   struct ColumnHasher {
+      static_assert(std::is_integral_v<Offset>, "offsets must be integral");
+
+      using Result = std::invoke_result_t<const Hashfn&, std::string_view>;
+
+      /**
+       * @param hashfn hash function instance
+       * @param max highest level to consider, defaults to the dispatch level
+       * @throws std::runtime_error if Hashfn is not supported at max
+       */
+      explicit ColumnHasher(const Hashfn& hashfn = Hashfn(), const dispatch::Level& max = dispatch::level())
+         : hashfn(hashfn), kernel(select(std::min(max, dispatch::level()))) {}
+
+      static std::string name() {
+         return "columnar_" + Hashfn::name();
+      }
+
+      /**
+       * hashes n strings into out, i.e., out[i] = hashfn(string i)
+       *
+       * @param offsets n + 1 ascending offsets into bytes
+       * @param bytes string data
+       */
+      forceinline void operator()(const Offset* offsets, const char* bytes, const size_t& n, Result* out) const {
+         kernel(hashfn, offsets, bytes, n, out);
+      }
+
+     private:
+      using Kernel = void (*)(const Hashfn&, const Offset*, const char*, size_t, Result*);
+      static constexpr dispatch::Level Min = dispatch::min_level<Hashfn>();
+
+      const Hashfn hashfn;
+      const Kernel kernel;
+
+      static Kernel select(const dispatch::Level& level) {
+         if (level < Min)
+            throw std::runtime_error(Hashfn::name() + " requires " + dispatch::name(Min) + " but only " +
+                                     dispatch::name(level) + " is available");
+
+         // AVX-512 offers no benefit for scalar string hashing
+         if (level >= dispatch::Level::AVX2)
+            return _::hash_avx2<Hashfn, Offset, Result>;
+         if (level == dispatch::Level::SSE42_AES)
+            return _::hash_sse42aes<Hashfn, Offset, Result>;
+         if constexpr (Min == dispatch::Level::SCALAR)
+            return _::hash_scalar<Hashfn, Offset, Result>;
+         throw std::runtime_error("unknown dispatch level");
+      }
+   };
+} // namespace hashing::columnar
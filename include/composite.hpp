@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "reduction.hpp"
+#include "types.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing {
+   /**
+    * Hashes composite keys, e.g., (tenant_id, object_id) pairs, without materializing
+    * them in a contiguous buffer. Each column is hashed by its own Hashfn<Key> instance
+    * and the column hashes are folded left to right with a Murmur-inspired 128 to 64 bit
+    * mixing step. Unlike xor, folding is order dependent, i.e., (a, b) and (b, a) collide
+    * no more often than any other pair, and equal columns do not cancel out.
+    *
+    * @tparam Hashfn hash function template, instantiated per column, e.g., XXHash3 or MurmurFinalizer
+    * @tparam Keys column types
+    */
+   template<template<class> class Hashfn, class... Keys>
+   struct CompositeHash {
+      static_assert(sizeof...(Keys) > 0, "composite keys require at least one column");
+
+      static std::string name() {
+         std::string res = "composite";
+         ((res += "_" + Hashfn<Keys>::name()), ...);
+         return res;
+      }
+
+      CompositeHash() = default;
+
+      /**
+       * @param hashfns per column hash function instances, e.g., differently seeded
+       */
+      explicit CompositeHash(const Hashfn<Keys>&... hashfns) : hashfns(hashfns...) {}
+
+      forceinline HASH_64 operator()(const Keys&... keys) const {
+         return hash(std::index_sequence_for<Keys...>{}, keys...);
+      }
+
+      forceinline HASH_64 operator()(const std::tuple<Keys...>& key) const {
+         return std::apply([&](const Keys&... keys) { return (*this)(keys...); }, key);
+      }
+
+      /**
+       * Hashes n composite keys given in columnar layout, i.e., key i is
+       * (columns[0][i], columns[1][i], ...). Columns are processed one at a
+       * time, which keeps each column hash loop tight and vectorizable
+       */
+      void operator()(const Keys*... columns, const size_t& n, HASH_64* out) const {
+         hash_columns(std::index_sequence_for<Keys...>{}, n, out, columns...);
+      }
+
+     private:
+      std::tuple<Hashfn<Keys>...> hashfns;
+
+      template<class Result>
+      static constexpr forceinline HASH_64 widen(const Result& hash) {
+         if constexpr (std::is_same_v<Result, HASH_128>)
+            return reduction::hash_128_to_64(hash);
+         else
+            return static_cast<HASH_64>(hash);
+      }
+
+      /**
+       * order dependent mixing step, folding the next column hash into the running hash
+       */
+      static constexpr forceinline HASH_64 combine(const HASH_64& hash, const HASH_64& next) {
+         return reduction::hash_128_to_64(to_hash128(hash, next));
+      }
+
+      template<size_t... I>
+      forceinline HASH_64 hash(std::index_sequence<I...>, const Keys&... keys) const {
+         HASH_64 res = 0;
+         ((res = I == 0 ? widen(std::get<I>(hashfns)(keys)) : combine(res, widen(std::get<I>(hashfns)(keys)))), ...);
+         return res;
+      }
+
+      template<size_t I, class Key>
+      forceinline void hash_column(const Key* column, const size_t& n, HASH_64* out) const {
+         const auto& hashfn = std::get<I>(hashfns);
+         if constexpr (I == 0) {
+            for (size_t i = 0; i < n; i++)
+               out[i] = widen(hashfn(column[i]));
+         } else {
+            for (size_t i = 0; i < n; i++)
+               out[i] = combine(out[i], widen(hashfn(column[i])));
+         }
+      }
+
+      template<size_t... I>
+      forceinline void hash_columns(std::index_sequence<I...>, const size_t& n, HASH_64* out,
+                                    const Keys*... columns) const {
+         (hash_column<I>(columns, n, out), ...);
+      }
+   };
+} // namespace hashing
@@ -8,10 +8,17 @@
       #define forceinline inline __attribute__((always_inline))
       #define likely(expr) __builtin_expect((bool) (expr), 1)
       #define unlikely(expr) __builtin_expect((bool) (expr), 0)
+      /// promise the compiler that expr holds, e.g., to eliminate impossible branches
+      #define assumeit(expr)            \
+         do {                           \
+            if (!(expr))                \
+               __builtin_unreachable(); \
+         } while (0)
    #else
       #define forceinline
       #define likely(expr) expr
       #define unlikely(expr) expr
+      #define assumeit(expr) UNUSED(expr)
    #endif
 
    #define neverinline __attribute__((noinline))
@@ -20,6 +27,29 @@
    #define prefetchit(address, mode, locality) __builtin_prefetch(address, mode, locality)
 
    #define full_mem_barrier __sync_synchronize()
+
+   /**
+    * Functions using SSE4.2/AES-NI or AVX2 intrinsics are compiled for their respective
+    * target, independent of the global -march flags. If the baseline target already
+    * supports the instructions, they are force inlined as usual. Otherwise they may only
+    * be inlined into callers compiled for (at least) the same target, e.g., dispatched
+    * batch kernels, and must only be called if hashing::dispatch reports support.
+    */
+   #define target_sse42aes __attribute__((target("sse4.2,aes")))
+   #define target_avx2 __attribute__((target("sse4.2,aes,avx2,bmi2")))
+   #define target_avx512 __attribute__((target("sse4.2,aes,avx2,bmi2,avx512f,avx512bw,avx512vl,avx512dq")))
+
+   #if defined(__SSE4_2__) && defined(__AES__)
+      #define forceinline_sse42aes forceinline
+   #else
+      #define forceinline_sse42aes inline target_sse42aes
+   #endif
+
+   #if defined(__AVX2__) && defined(__BMI2__) && defined(__AES__)
+      #define forceinline_avx2 forceinline
+   #else
+      #define forceinline_avx2 inline target_avx2
+   #endif
 #else
    #error "Your compiler is currently not supported"
 #endif
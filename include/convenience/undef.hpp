@@ -1,11 +1,17 @@
 #undef forceinline
 #undef likely
 #undef unlikely
+#undef assumeit
 #undef neverinline
 #undef alignit
 #undef packit
 #undef prefetchit
 #undef full_mem_barrier
+#undef target_sse42aes
+#undef target_avx2
+#undef target_avx512
+#undef forceinline_sse42aes
+#undef forceinline_avx2
 
 #undef UNUSED
 
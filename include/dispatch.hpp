@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::dispatch {
+   /**
+    * Instruction set levels, each including all lower ones
+    */
+   enum class Level : int
+   {
+      SCALAR = 0,
+      SSE42_AES = 1,
+      AVX2 = 2,
+      AVX512 = 3
+   };
+
+   inline std::string name(const Level& level) {
+      switch (level) {
+         case Level::SCALAR:
+            return "scalar";
+         case Level::SSE42_AES:
+            return "sse42_aes";
+         case Level::AVX2:
+            return "avx2";
+         case Level::AVX512:
+            return "avx512";
+      }
+      return "unknown";
+   }
+
+   /**
+    * @return highest level supported by the executing cpu
+    */
+   inline Level detect() {
+      __builtin_cpu_init();
+
+      if (!__builtin_cpu_supports("sse4.2") || !__builtin_cpu_supports("aes"))
+         return Level::SCALAR;
+      if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi2"))
+         return Level::SSE42_AES;
+      if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw") ||
+          !__builtin_cpu_supports("avx512vl") || !__builtin_cpu_supports("avx512dq"))
+         return Level::AVX2;
+      return Level::AVX512;
+   }
+
+   /**
+    * Level used for dispatching, detected once at startup. Can be lowered (but not
+    * raised beyond what the cpu supports) by setting the HASHING_DISPATCH environment
+    * variable to one of scalar, sse42_aes, avx2 or avx512, e.g., to benchmark fallbacks
+    */
+   inline Level level() {
+      static const Level level = [] {
+         const Level detected = detect();
+
+         const char* env = std::getenv("HASHING_DISPATCH");
+         if (env == nullptr)
+            return detected;
+
+         for (const auto& l : {Level::SCALAR, Level::SSE42_AES, Level::AVX2, Level::AVX512})
+            if (name(l) == env)
+               return std::min(l, detected);
+         throw std::runtime_error("invalid HASHING_DISPATCH value '" + std::string(env) + "'");
+      }();
+      return level;
+   }
+
+   /**
+    * Minimum level a hash function requires, declared via a static min_level member
+    * by functions that unconditionally use intrinsics (e.g., AquaHash). Defaults to SCALAR
+    */
+   template<class Hashfn>
+   constexpr Level min_level() {
+      if constexpr (requires { Hashfn::min_level; })
+         return Hashfn::min_level;
+      else
+         return Level::SCALAR;
+   }
+
+   /**
+    * Amount of low bits Hashfn's results may set when hashing Key, declared via a static
+    * output_bits member by functions whose result type is wider than their hashes (e.g.,
+    * XXHash32). Defaults to the width of the result type
+    */
+   template<class Hashfn, class Key>
+   constexpr size_t output_bits() {
+      if constexpr (requires { Hashfn::output_bits; })
+         return Hashfn::output_bits;
+      else
+         return sizeof(std::invoke_result_t<const Hashfn&, const Key&>) * 8;
+   }
+
+   /**
+    * @return whether Hashfn may be executed on this cpu
+    */
+   template<class Hashfn>
+   inline bool supported() {
+      return level() >= min_level<Hashfn>();
+   }
+
+   namespace _ {
+      template<class Key, class Hashfn, class Result>
+      void hash_scalar(const Hashfn& hashfn, const Key* keys, const size_t n, Result* out) {
+         for (size_t i = 0; i < n; i++)
+            out[i] = hashfn(keys[i]);
+      }
+
+      template<class Key, class Hashfn, class Result>
+      target_sse42aes void hash_sse42aes(const Hashfn& hashfn, const Key* keys, const size_t n, Result* out) {
+         for (size_t i = 0; i < n; i++)
+            out[i] = hashfn(keys[i]);
+      }
+
+      template<class Key, class Hashfn, class Result>
+      target_avx2 void hash_avx2(const Hashfn& hashfn, const Key* keys, const size_t n, Result* out) {
+         for (size_t i = 0; i < n; i++)
+            out[i] = hashfn(keys[i]);
+      }
+
+      template<class Key, class Hashfn, class Result>
+      target_avx512 void hash_avx512(const Hashfn& hashfn, const Key* keys, const size_t n, Result* out) {
+         for (size_t i = 0; i < n; i++)
+            out[i] = hashfn(keys[i]);
+      }
+   } // namespace _
+
+   /**
+    * Hashes arrays of keys using a kernel compiled for the highest level supported by the
+    * cpu. All kernels share the same source; hash functions are inlined into each of them
+    * and thereby vectorized with the respective instruction set, e.g., 64-bit multiplies
+    * of MurmurFinalizer or the multiplicative hashes only vectorize with AVX-512DQ.
+    *
+    * @tparam Key key type
+    * @tparam Hashfn hash function
+    */
+   template<class Key, class Hashfn>
+   struct BatchHasher {
+      using Result = std::invoke_result_t<const Hashfn&, const Key&>;
+
+      /**
+       * @param hashfn hash function instance
+       * @param max highest level to consider, defaults to the dispatch level
+       * @throws std::runtime_error if Hashfn is not supported at max
+       */
+      explicit BatchHasher(const Hashfn& hashfn = Hashfn(), const Level& max = dispatch::level())
+         : hashfn(hashfn), selected(std::min(max, dispatch::level())), kernel(select(selected)) {}
+
+      static std::string name() {
+         return Hashfn::name();
+      }
+
+      /**
+       * hashes n keys into out
+       */
+      forceinline void operator()(const Key* keys, const size_t& n, Result* out) const {
+         kernel(hashfn, keys, n, out);
+      }
+
+      /**
+       * @return level of the selected kernel
+       */
+      Level kernel_level() const {
+         return selected;
+      }
+
+     private:
+      using Kernel = void (*)(const Hashfn&, const Key*, size_t, Result*);
+      static constexpr Level Min = min_level<Hashfn>();
+
+      const Hashfn hashfn;
+      const Level selected;
+      const Kernel kernel;
+
+      static Kernel select(const Level& level) {
+         if (level < Min)
+            throw std::runtime_error(Hashfn::name() + " requires " + dispatch::name(Min) + " but only " +
+                                     dispatch::name(level) + " is available");
+
+         // kernels below Min are never instantiated since they could not inline the hash function
+         switch (level) {
+            case Level::AVX512:
+               return _::hash_avx512<Key, Hashfn, Result>;
+            case Level::AVX2:
+               return _::hash_avx2<Key, Hashfn, Result>;
+            case Level::SSE42_AES:
+               return _::hash_sse42aes<Key, Hashfn, Result>;
+            case Level::SCALAR:
+               if constexpr (Min == Level::SCALAR)
+                  return _::hash_scalar<Key, Hashfn, Result>;
+         }
+         throw std::runtime_error("unknown dispatch level");
+      }
+   };
+} // namespace hashing::dispatch
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dispatch.hpp"
+#include "types.hpp"
+#include "xxh.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::file {
+   /**
+    * Read-only memory mapping of an entire file
+    */
+   struct MappedFile {
+      /**
+       * @param populate prefault all pages (MAP_POPULATE), i.e., read the entire file
+       *    now instead of faulting on first access
+       * @throws std::runtime_error if the file can not be opened or mapped
+       */
+      explicit MappedFile(const std::string& path, const bool& populate = false) {
+         const int fd = ::open(path.c_str(), O_RDONLY);
+         if (fd < 0)
+            throw std::runtime_error("could not open '" + path + "': " + std::strerror(errno));
+
+         struct stat st {};
+         if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::runtime_error("could not stat '" + path + "': " + std::strerror(err));
+         }
+         size_ = static_cast<size_t>(st.st_size);
+
+         // mapping zero bytes is an error
+         if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+            if (addr == MAP_FAILED) {
+               const int err = errno;
+               ::close(fd);
+               throw std::runtime_error("could not mmap '" + path + "': " + std::strerror(err));
+            }
+            data_ = static_cast<const char*>(addr);
+         }
+         // the mapping remains valid after closing its file descriptor
+         ::close(fd);
+      }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      ~MappedFile() {
+         if (data_ != nullptr)
+            ::munmap(const_cast<char*>(data_), size_);
+      }
+
+      /**
+       * Advises the kernel on the expected access pattern, e.g., MADV_SEQUENTIAL
+       * to read ahead aggressively. Failures are ignored since this is a hint only
+       */
+      void advise(const int& advice) const {
+         if (data_ != nullptr)
+            ::madvise(const_cast<char*>(data_), size_, advice);
+      }
+
+      const char* data() const {
+         return data_;
+      }
+
+      size_t size() const {
+         return size_;
+      }
+
+      std::string_view view() const {
+         return {data_, size_};
+      }
+
+     private:
+      const char* data_ = nullptr;
+      size_t size_ = 0;
+   };
+
+   struct TreeOptions {
+      /// input is split into chunks of this many bytes (the last one may be shorter). The
+      /// digest depends on the chunk size, i.e., it must be fixed to compare digests
+      size_t chunk_size = 16 * 1024 * 1024;
+
+      /// amount of threads hashing chunks. Defaults to all hardware threads
+      size_t num_threads = std::thread::hardware_concurrency();
+   };
+
+   /**
+    * Hashes data with a two level tree: chunks of options.chunk_size bytes are hashed
+    * independently on up to options.num_threads threads, then the concatenation of all
+    * chunk digests (in order, little endian) is hashed into the root digest. Unlike a
+    * single streaming pass, throughput scales with the amount of cores. The digest only
+    * depends on the data and the chunk size, never on the amount of threads.
+    *
+    * @tparam Hashfn hash function providing operator()(std::string_view), e.g., XXHash3_128
+    *    or MeowHash128. 128-bit functions are recommended since the root hashes a digest
+    *    per chunk
+    * @throws std::runtime_error if the cpu does not support Hashfn or chunk_size is 0
+    */
+   template<class Hashfn = XXHash3_128<HASH_64>>
+   auto hash_tree(const std::string_view& data, const TreeOptions& options = TreeOptions(),
+                  const Hashfn& hashfn = Hashfn()) {
+      using Digest = std::invoke_result_t<const Hashfn&, std::string_view>;
+      static_assert(std::is_integral_v<Digest> || std::is_same_v<Digest, HASH_128>,
+                    "chunk digests must be plain integers");
+
+      if (!dispatch::supported<Hashfn>())
+         throw std::runtime_error(Hashfn::name() + " is not supported by this cpu");
+      if (options.chunk_size == 0)
+         throw std::runtime_error("tree chunk size must be positive");
+
+      const size_t chunks = (data.size() + options.chunk_size - 1) / options.chunk_size;
+      std::vector<Digest> digests(chunks);
+
+      // chunks are claimed one at a time since their hashing time varies, e.g., with page faults
+      std::atomic<size_t> next{0};
+      const auto work = [&] {
+         for (size_t c = next.fetch_add(1, std::memory_order_relaxed); c < chunks;
+              c = next.fetch_add(1, std::memory_order_relaxed))
+            digests[c] = hashfn(data.substr(c * options.chunk_size, options.chunk_size));
+      };
+
+      const size_t threads =
+         std::clamp(options.num_threads, static_cast<size_t>(1), std::max(chunks, static_cast<size_t>(1)));
+      std::vector<std::thread> workers;
+      workers.reserve(threads - 1);
+      for (size_t t = 1; t < threads; t++)
+         workers.emplace_back(work);
+      work();
+      for (auto& worker : workers)
+         worker.join();
+
+      return hashfn(std::string_view(reinterpret_cast<const char*>(digests.data()), digests.size() * sizeof(Digest)));
+   }
+
+   /**
+    * Memory maps the file at path and hashes it using hash_tree()
+    *
+    * @throws std::runtime_error if the file can not be mapped
+    */
+   template<class Hashfn = XXHash3_128<HASH_64>>
+   auto hash_file(const std::string& path, const TreeOptions& options = TreeOptions(),
+                  const Hashfn& hashfn = Hashfn()) {
+      const MappedFile file(path);
+      file.advise(MADV_SEQUENTIAL);
+      return hash_tree(file.view(), options, hashfn);
+   }
+} // namespace hashing::file
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "../dispatch.hpp"
+#include "../reduction.hpp"
+#include "../types.hpp"
+
+// Order important
+#include "../convenience/builtins.hpp"
+
+namespace hashing::filter {
+   /**
+    * Cache-line blocked bloom filter. Each key is mapped to exactly one 64 byte block
+    * and sets up to k bits inside of it, at most one per 64-bit word. Therefore, each
+    * insert or lookup touches exactly one cache line.
+    *
+    * All positions are derived from a single hash value: the upper 32 bits select the
+    * block via Fastrange, the lower 32 bits are multiplied by k odd salts and the top
+    * 6 bits of each product select the bit inside the respective word (similar to
+    * the register blocked filters in Apache Impala/Kudu). With AVX2, all k bits of a
+    * key are computed, set and tested in two 256-bit registers. Batched operations
+    * select the AVX2 kernel at runtime, single key operations only when compiled for AVX2.
+    *
+    * @tparam Key key type
+    * @tparam Hashfn hash function producing 64 bit hash values
+    * @tparam k number of bits set per key, in [1, 8]
+    */
+   template<class Key, class Hashfn, const size_t k = 8>
+   struct BlockedBloom {
+      static_assert(k > 0 && k <= 8, "blocked bloom filter sets between 1 and 8 bits per key");
+      // the block is derived from the upper 32 hash bits, i.e., narrower hashes would all map to 0
+      static_assert(dispatch::output_bits<Hashfn, Key>() == 64, "Hashfn must produce 64 bit hash values");
+
+      /**
+       * Constructs an empty filter
+       *
+       * @param capacity expected number of keys
+       * @param bits_per_key memory budget per key. The default of 10 results in
+       *    roughly 1% false positives at full capacity
+       */
+      explicit BlockedBloom(const size_t& capacity, const size_t& bits_per_key = 10)
+         : blocks(num_blocks(capacity, bits_per_key)), reductionfn(blocks.size()) {}
+
+      /**
+       * Constructs a filter containing all keys
+       *
+       * @param keys
+       * @param bits_per_key memory budget per key
+       */
+      explicit BlockedBloom(const std::vector<Key>& keys, const size_t& bits_per_key = 10)
+         : BlockedBloom(keys.size(), bits_per_key) {
+         insert(keys.data(), keys.size());
+      }
+
+      static std::string name() {
+         return "blocked_bloom" + std::to_string(k) + "_" + Hashfn::name();
+      }
+
+      forceinline void insert(const Key& key) {
+         const HASH_64 hash = hashfn(key);
+#ifdef __AVX2__
+         insert_hash_avx2(block_index(hash), static_cast<HASH_32>(hash));
+#else
+         insert_hash(block_index(hash), static_cast<HASH_32>(hash));
+#endif
+      }
+
+      forceinline bool contains(const Key& key) const {
+         const HASH_64 hash = hashfn(key);
+#ifdef __AVX2__
+         return contains_hash_avx2(block_index(hash), static_cast<HASH_32>(hash));
+#else
+         return contains_hash(block_index(hash), static_cast<HASH_32>(hash));
+#endif
+      }
+
+      /**
+       * Inserts n keys. Keys are hashed in small batches whose blocks
+       * are prefetched before any of them is modified.
+       */
+      void insert(const Key* keys, const size_t& n) {
+         if (dispatch::level() >= dispatch::Level::AVX2)
+            insert_batch_avx2(keys, n);
+         else
+            insert_batch(keys, n);
+      }
+
+      /**
+       * Looks up n keys and writes whether each key might be contained to result
+       */
+      void contains(const Key* keys, const size_t& n, bool* result) const {
+         if (dispatch::level() >= dispatch::Level::AVX2)
+            contains_batch_avx2(keys, n, result);
+         else
+            contains_batch(keys, n, result);
+      }
+
+      /**
+       * Removes all keys
+       */
+      void clear() {
+         std::fill(blocks.begin(), blocks.end(), Block{});
+      }
+
+      /**
+       * @return size of the filter in bytes
+       */
+      size_t byte_size() const {
+         return blocks.size() * sizeof(Block);
+      }
+
+     private:
+      struct alignas(64) Block {
+         std::uint64_t words[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      };
+      static_assert(sizeof(Block) == 64);
+
+      /// amount of keys for which blocks are prefetched ahead of time
+      static constexpr size_t Batch = 16;
+
+      static constexpr HASH_32 salts[8] = {0x47b6137bLU, 0x44974d91LU, 0x8824ad5bLU, 0xa2b7289dLU,
+                                           0x705495c7LU, 0x2df1424bLU, 0x9efc4947LU, 0x5c6bfb31LU};
+
+      std::vector<Block> blocks;
+      const reduction::Fastrange<HASH_32> reductionfn;
+      Hashfn hashfn;
+
+      static size_t num_blocks(const size_t& capacity, const size_t& bits_per_key) {
+         const size_t bits = std::max(capacity * bits_per_key, static_cast<size_t>(1));
+         const size_t cnt = (bits + 8 * sizeof(Block) - 1) / (8 * sizeof(Block));
+         if (cnt > std::numeric_limits<HASH_32>::max())
+            throw std::runtime_error("blocked bloom filter with " + std::to_string(cnt) + " blocks is too large");
+         return cnt;
+      }
+
+      forceinline size_t block_index(const HASH_64& hash) const {
+         return reductionfn(static_cast<HASH_32>(hash >> 32));
+      }
+
+      /**
+       * hashes a batch of keys and prefetches their blocks
+       * @tparam mode prefetch mode, i.e., 0 for reading and 1 for writing
+       */
+      template<const int mode>
+      forceinline void prepare_batch(const Key* keys, const size_t& cnt, std::array<size_t, Batch>& indices,
+                                     std::array<HASH_32, Batch>& hashes) const {
+         for (size_t j = 0; j < cnt; j++) {
+            const HASH_64 hash = hashfn(keys[j]);
+            indices[j] = block_index(hash);
+            hashes[j] = static_cast<HASH_32>(hash);
+            prefetchit(&blocks[indices[j]], mode, 3);
+         }
+      }
+
+      void insert_batch(const Key* keys, const size_t& n) {
+         std::array<size_t, Batch> indices;
+         std::array<HASH_32, Batch> hashes;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            prepare_batch<1>(keys + i, cnt, indices, hashes);
+            for (size_t j = 0; j < cnt; j++)
+               insert_hash(indices[j], hashes[j]);
+         }
+      }
+
+      void contains_batch(const Key* keys, const size_t& n, bool* result) const {
+         std::array<size_t, Batch> indices;
+         std::array<HASH_32, Batch> hashes;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            prepare_batch<0>(keys + i, cnt, indices, hashes);
+            for (size_t j = 0; j < cnt; j++)
+               result[i + j] = contains_hash(indices[j], hashes[j]);
+         }
+      }
+
+      target_avx2 void insert_batch_avx2(const Key* keys, const size_t& n) {
+         std::array<size_t, Batch> indices;
+         std::array<HASH_32, Batch> hashes;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            prepare_batch<1>(keys + i, cnt, indices, hashes);
+            for (size_t j = 0; j < cnt; j++)
+               insert_hash_avx2(indices[j], hashes[j]);
+         }
+      }
+
+      target_avx2 void contains_batch_avx2(const Key* keys, const size_t& n, bool* result) const {
+         std::array<size_t, Batch> indices;
+         std::array<HASH_32, Batch> hashes;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            prepare_batch<0>(keys + i, cnt, indices, hashes);
+            for (size_t j = 0; j < cnt; j++)
+               result[i + j] = contains_hash_avx2(indices[j], hashes[j]);
+         }
+      }
+
+      static constexpr forceinline std::uint64_t mask(const HASH_32& h, const size_t& i) {
+         return 0x1LLU << ((h * salts[i]) >> 26);
+      }
+
+      forceinline void insert_hash(const size_t& index, const HASH_32& h) {
+         auto& block = blocks[index];
+         for (size_t i = 0; i < k; i++)
+            block.words[i] |= mask(h, i);
+      }
+
+      forceinline bool contains_hash(const size_t& index, const HASH_32& h) const {
+         const auto& block = blocks[index];
+         bool res = true;
+         for (size_t i = 0; i < k; i++)
+            res &= (block.words[i] & mask(h, i)) != 0;
+         return res;
+      }
+
+      /**
+       * computes the 8 word masks for hash h, split across two 256-bit registers
+       */
+      static forceinline_avx2 void masks(const HASH_32& h, __m256i& lo, __m256i& hi) {
+         const __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(salts));
+         const __m256i pos = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(h), salt), 26);
+
+         // only the first k words receive a bit
+         const __m256i ones_lo = _mm256_setr_epi64x(k > 0, k > 1, k > 2, k > 3);
+         const __m256i ones_hi = _mm256_setr_epi64x(k > 4, k > 5, k > 6, k > 7);
+
+         lo = _mm256_sllv_epi64(ones_lo, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(pos)));
+         hi = _mm256_sllv_epi64(ones_hi, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pos, 1)));
+      }
+
+      forceinline_avx2 void insert_hash_avx2(const size_t& index, const HASH_32& h) {
+         __m256i lo, hi;
+         masks(h, lo, hi);
+
+         auto* words = reinterpret_cast<__m256i*>(blocks[index].words);
+         _mm256_store_si256(words, _mm256_or_si256(_mm256_load_si256(words), lo));
+         _mm256_store_si256(words + 1, _mm256_or_si256(_mm256_load_si256(words + 1), hi));
+      }
+
+      forceinline_avx2 bool contains_hash_avx2(const size_t& index, const HASH_32& h) const {
+         __m256i lo, hi;
+         masks(h, lo, hi);
+
+         const auto* words = reinterpret_cast<const __m256i*>(blocks[index].words);
+         return _mm256_testc_si256(_mm256_load_si256(words), lo) & _mm256_testc_si256(_mm256_load_si256(words + 1), hi);
+      }
+   };
+} // namespace hashing::filter
@@ -0,0 +1,330 @@
+/**
+ * Cuckoo filter as proposed by Fan et al.: "Cuckoo Filter: Practically Better Than Bloom" (CoNEXT 2014).
+ *
+ * While this implementation is original, the idea of partial-key cuckoo hashing is not.
+ * Alternate buckets are computed with the subtraction variant of partial-key cuckoo hashing
+ * (i.e., i2 = h(fp) - i1 mod m), which, unlike the xor variant, does not require a power of
+ * two amount of buckets.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../dispatch.hpp"
+#include "../reduction.hpp"
+#include "../types.hpp"
+
+// Order important
+#include "../convenience/builtins.hpp"
+
+namespace hashing::filter {
+   /**
+    * Dynamic membership filter supporting deletions. Each bucket holds 4
+    * fingerprints, which are densely packed (4 * bits_per_fingerprint bits
+    * per bucket). Fingerprint 0 marks an empty slot.
+    *
+    * NOTE: like all cuckoo filters, only keys that were previously inserted
+    * may be removed. Inserting the same key more than 8 times (2 buckets * 4
+    * slots) is not supported.
+    *
+    * @tparam Key key type
+    * @tparam Hashfn hash function producing 64 bit hash values
+    * @tparam bits_per_fingerprint one of 8, 12 or 16
+    */
+   template<class Key, class Hashfn, const size_t bits_per_fingerprint = 12>
+   struct CuckooFilter {
+      static_assert(bits_per_fingerprint == 8 || bits_per_fingerprint == 12 || bits_per_fingerprint == 16,
+                    "only 8, 12 and 16 bit fingerprints are supported");
+      // the bucket is derived from the upper 32 hash bits, i.e., narrower hashes would all map to 0
+      static_assert(dispatch::output_bits<Hashfn, Key>() == 64, "Hashfn must produce 64 bit hash values");
+
+      /**
+       * Constructs an empty filter
+       *
+       * @param capacity maximum amount of keys. Buckets are sized
+       *    for a load factor of 95% at full capacity
+       */
+      explicit CuckooFilter(const size_t& capacity)
+         : num_buckets(std::max(static_cast<size_t>(std::ceil(static_cast<double>(capacity) / (SlotsPerBucket * 0.95))),
+                                static_cast<size_t>(1))),
+           reductionfn(num_buckets), table(num_buckets * BucketBytes + sizeof(std::uint64_t), 0) {
+         if (num_buckets > std::numeric_limits<HASH_32>::max())
+            throw std::runtime_error("cuckoo filter with " + std::to_string(num_buckets) + " buckets is too large");
+      }
+
+      /**
+       * Constructs a filter containing all keys
+       *
+       * @param keys
+       */
+      explicit CuckooFilter(const std::vector<Key>& keys) : CuckooFilter(keys.size()) {
+         for (const auto& key : keys)
+            if (!insert(key))
+               throw std::runtime_error("failed to insert key into " + name());
+      }
+
+      static std::string name() {
+         return "cuckoo" + std::to_string(bits_per_fingerprint) + "_" + Hashfn::name();
+      }
+
+      /**
+       * Inserts a key
+       * @return false if the filter is full, in which case the key was not inserted
+       */
+      bool insert(const Key& key) {
+         if (victim.used)
+            return false;
+
+         size_t index;
+         Fingerprint fp;
+         locate(key, index, fp);
+
+         if (try_add(index, fp) || try_add(alternate(index, fp), fp)) {
+            items++;
+            return true;
+         }
+
+         // relocate random fingerprints until a free slot is found
+         if (next_random() & 0x1)
+            index = alternate(index, fp);
+         for (size_t kick = 0; kick < MaxKicks; kick++) {
+            const auto slot = next_random() % SlotsPerBucket;
+            const auto evicted = get(index, slot);
+            set(index, slot, fp);
+            fp = evicted;
+
+            index = alternate(index, fp);
+            if (try_add(index, fp)) {
+               items++;
+               return true;
+            }
+         }
+
+         // stash the last evicted fingerprint. This way, insert never loses a previously inserted key
+         victim = {index, fp, true};
+         items++;
+         return true;
+      }
+
+      /**
+       * Removes a previously inserted key
+       * @return false if the key was not found
+       */
+      bool remove(const Key& key) {
+         size_t index;
+         Fingerprint fp;
+         locate(key, index, fp);
+         const auto alt_index = alternate(index, fp);
+
+         if (try_remove(index, fp) || try_remove(alt_index, fp)) {
+            items--;
+
+            // space was freed, attempt to move the victim back into the table
+            if (victim.used) {
+               victim.used = false;
+               items--;
+               reinsert(victim.index, victim.fp);
+            }
+            return true;
+         }
+
+         if (victim.used && victim.fp == fp && (victim.index == index || victim.index == alt_index)) {
+            victim.used = false;
+            items--;
+            return true;
+         }
+
+         return false;
+      }
+
+      forceinline bool contains(const Key& key) const {
+         size_t index;
+         Fingerprint fp;
+         locate(key, index, fp);
+         return contains(index, alternate(index, fp), fp);
+      }
+
+      /**
+       * Looks up n keys and writes whether each key might be contained to result.
+       * Both buckets of each key in a small batch are prefetched ahead of time
+       */
+      void contains(const Key* keys, const size_t& n, bool* result) const {
+         std::array<size_t, Batch> indices, alt_indices;
+         std::array<Fingerprint, Batch> fps;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            for (size_t j = 0; j < cnt; j++) {
+               locate(keys[i + j], indices[j], fps[j]);
+               alt_indices[j] = alternate(indices[j], fps[j]);
+               prefetchit(&table[indices[j] * BucketBytes], 0, 3);
+               prefetchit(&table[alt_indices[j] * BucketBytes], 0, 3);
+            }
+            for (size_t j = 0; j < cnt; j++)
+               result[i + j] = contains(indices[j], alt_indices[j], fps[j]);
+         }
+      }
+
+      /**
+       * @return amount of keys currently contained in the filter
+       */
+      size_t size() const {
+         return items;
+      }
+
+      /**
+       * @return size of the filter in bytes
+       */
+      size_t byte_size() const {
+         return table.size();
+      }
+
+     private:
+      using Fingerprint = std::conditional_t<bits_per_fingerprint <= 8, std::uint8_t, std::uint16_t>;
+
+      static constexpr size_t SlotsPerBucket = 4;
+      static constexpr size_t BucketBits = SlotsPerBucket * bits_per_fingerprint;
+      static constexpr size_t BucketBytes = BucketBits / 8;
+      static constexpr std::uint64_t FingerprintMask = (0x1LLU << bits_per_fingerprint) - 1;
+      static constexpr std::uint64_t BucketMask = BucketBits == 64 ? ~0x0LLU : (0x1LLU << BucketBits) - 1;
+
+      /// lowest bit of every slot set, i.e., 0x0001000100010001 for 16 bit fingerprints
+      static constexpr std::uint64_t LowBits = BucketMask / FingerprintMask;
+      /// highest bit of every slot set, i.e., 0x8000800080008000 for 16 bit fingerprints
+      static constexpr std::uint64_t HighBits = LowBits << (bits_per_fingerprint - 1);
+
+      /// maximum amount of relocations per insert
+      static constexpr size_t MaxKicks = 500;
+      /// amount of keys whose buckets are prefetched ahead of time
+      static constexpr size_t Batch = 16;
+
+      const size_t num_buckets;
+      const reduction::Fastrange<HASH_32> reductionfn;
+      Hashfn hashfn;
+
+      /// densely packed buckets, padded to allow unaligned 8 byte accesses to the last bucket
+      std::vector<std::uint8_t> table;
+      size_t items = 0;
+
+      struct {
+         size_t index = 0;
+         Fingerprint fp = 0;
+         bool used = false;
+      } victim;
+
+      std::uint64_t random_state = 0x238EF8E3LU;
+
+      forceinline std::uint64_t next_random() {
+         // xorshift64
+         random_state ^= random_state << 13;
+         random_state ^= random_state >> 7;
+         random_state ^= random_state << 17;
+         return random_state;
+      }
+
+      /**
+       * derives the primary bucket (upper 32 hash bits) and the
+       * fingerprint (lower hash bits, never 0) from a single hash
+       */
+      forceinline void locate(const Key& key, size_t& index, Fingerprint& fp) const {
+         const HASH_64 hash = hashfn(key);
+         index = reductionfn(static_cast<HASH_32>(hash >> 32));
+         fp = static_cast<Fingerprint>(hash & FingerprintMask);
+         fp += fp == 0;
+      }
+
+      /**
+       * partial-key cuckoo hashing. Since (h - (h - i)) mod m = i, this is an involution
+       */
+      forceinline size_t alternate(const size_t& index, const Fingerprint& fp) const {
+         const size_t h = reductionfn(static_cast<HASH_32>(fp * 0x5bd1e995LU));
+         return h >= index ? h - index : h + num_buckets - index;
+      }
+
+      forceinline std::uint64_t read(const size_t& index) const {
+         std::uint64_t bucket;
+         std::memcpy(&bucket, &table[index * BucketBytes], sizeof(bucket));
+         return bucket & BucketMask;
+      }
+
+      forceinline void write(const size_t& index, const std::uint64_t& bucket) {
+         std::uint64_t word;
+         std::memcpy(&word, &table[index * BucketBytes], sizeof(word));
+         word = (word & ~BucketMask) | bucket;
+         std::memcpy(&table[index * BucketBytes], &word, sizeof(word));
+      }
+
+      forceinline Fingerprint get(const size_t& index, const size_t& slot) const {
+         return (read(index) >> (slot * bits_per_fingerprint)) & FingerprintMask;
+      }
+
+      forceinline void set(const size_t& index, const size_t& slot, const Fingerprint& fp) {
+         const auto shift = slot * bits_per_fingerprint;
+         write(index, (read(index) & ~(FingerprintMask << shift)) | (static_cast<std::uint64_t>(fp) << shift));
+      }
+
+      /**
+       * SWAR test whether any slot of bucket equals fp
+       */
+      static constexpr forceinline bool has(const std::uint64_t& bucket, const Fingerprint& fp) {
+         const std::uint64_t x = bucket ^ (fp * LowBits);
+         return ((x - LowBits) & ~x & HighBits) != 0;
+      }
+
+      forceinline bool contains(const size_t& index, const size_t& alt_index, const Fingerprint& fp) const {
+         const bool stashed = victim.used && victim.fp == fp && (victim.index == index || victim.index == alt_index);
+         return stashed | has(read(index), fp) | has(read(alt_index), fp);
+      }
+
+      forceinline bool try_add(const size_t& index, const Fingerprint& fp) {
+         for (size_t slot = 0; slot < SlotsPerBucket; slot++) {
+            if (get(index, slot) == 0) {
+               set(index, slot, fp);
+               return true;
+            }
+         }
+         return false;
+      }
+
+      forceinline bool try_remove(const size_t& index, const Fingerprint& fp) {
+         for (size_t slot = 0; slot < SlotsPerBucket; slot++) {
+            if (get(index, slot) == fp) {
+               set(index, slot, 0);
+               return true;
+            }
+         }
+         return false;
+      }
+
+      /**
+       * reinserts a fingerprint without knowing its key
+       */
+      void reinsert(size_t index, Fingerprint fp) {
+         for (size_t kick = 0; kick <= MaxKicks; kick++) {
+            if (try_add(index, fp)) {
+               items++;
+               return;
+            }
+
+            const auto slot = next_random() % SlotsPerBucket;
+            const auto evicted = get(index, slot);
+            set(index, slot, fp);
+            fp = evicted;
+            index = alternate(index, fp);
+         }
+
+         victim = {index, fp, true};
+         items++;
+      }
+   };
+} // namespace hashing::filter
@@ -0,0 +1,428 @@
+/**
+ * Xor filters and binary fuse filters as proposed by Thomas Mueller Graf and Daniel Lemire:
+ *   - "Xor Filters: Faster and Smaller Than Bloom and Cuckoo Filters" (JEA 2020)
+ *   - "Binary Fuse Filters: Fast and Smaller Than Xor Filters" (JEA 2022)
+ *
+ * While this implementation is original, layout parameters were taken from the
+ * reference implementation at https://github.com/FastFilter/xor_singleheader
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../murmur.hpp"
+#include "../reduction.hpp"
+#include "../types.hpp"
+
+// Order important
+#include "../convenience/builtins.hpp"
+
+namespace hashing::filter {
+   namespace _ {
+      /**
+       * Classic 3-wise xor filter layout: the fingerprint array is split into three
+       * equally sized segments, each key has exactly one position per segment.
+       */
+      struct XorLayout {
+         explicit XorLayout(const size_t& num_keys)
+            : segment_length((32 + static_cast<size_t>(std::ceil(1.23 * static_cast<double>(num_keys)))) / 3),
+              reductionfn(segment_length) {}
+
+         forceinline std::array<size_t, 3> positions(const HASH_64& hash) const {
+            return {reductionfn(static_cast<HASH_32>(hash)),
+                    reductionfn(static_cast<HASH_32>(rotl(hash, 21))) + segment_length,
+                    reductionfn(static_cast<HASH_32>(rotl(hash, 42))) + 2 * segment_length};
+         }
+
+         size_t size() const {
+            return 3 * segment_length;
+         }
+
+        private:
+         const size_t segment_length;
+         const reduction::Fastrange<HASH_32> reductionfn;
+
+         static constexpr forceinline HASH_64 rotl(const HASH_64& x, const int r) {
+            return (x << r) | (x >> (64 - r));
+         }
+      };
+
+      /**
+       * Binary fuse layout: the array consists of many small power of two segments.
+       * Each key selects three consecutive segments via Fastrange and one position
+       * in each of them, which results in much better space efficiency (~1.125 instead
+       * of 1.23 slots per key) and better locality than classic xor filters.
+       */
+      struct BinaryFuseLayout {
+         explicit BinaryFuseLayout(const size_t& num_keys)
+            : segment_length(calculate_segment_length(num_keys)), segment_length_mask(segment_length - 1),
+              segment_count(calculate_segment_count(num_keys, segment_length)),
+              reductionfn(segment_count * segment_length) {}
+
+         forceinline std::array<size_t, 3> positions(const HASH_64& hash) const {
+            const size_t h0 = reductionfn(hash);
+            const size_t h1 = (h0 + segment_length) ^ ((hash >> 18) & segment_length_mask);
+            const size_t h2 = (h0 + 2 * segment_length) ^ (hash & segment_length_mask);
+            return {h0, h1, h2};
+         }
+
+         size_t size() const {
+            return (segment_count + 2) * segment_length;
+         }
+
+        private:
+         const size_t segment_length;
+         const size_t segment_length_mask;
+         const size_t segment_count;
+         const reduction::Fastrange<HASH_64> reductionfn;
+
+         static size_t calculate_segment_length(const size_t& num_keys) {
+            // these parameters are very sensitive, e.g., replacing 'floor' by 'round' causes
+            // massive construction failures (see reference implementation)
+            if (num_keys == 0)
+               return 4;
+            const auto exponent = static_cast<int>(std::floor(std::log(static_cast<double>(num_keys)) / std::log(3.33) + 2.25));
+            return std::min(static_cast<size_t>(1) << std::max(exponent, 0), static_cast<size_t>(262144));
+         }
+
+         static size_t calculate_segment_count(const size_t& num_keys, const size_t& segment_length) {
+            const double size_factor =
+               num_keys <= 1 ? 0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(static_cast<double>(num_keys)));
+            const auto capacity = static_cast<size_t>(std::round(static_cast<double>(num_keys) * size_factor));
+            return std::max((capacity + segment_length - 1) / segment_length, static_cast<size_t>(3)) - 2;
+         }
+      };
+
+      /**
+       * Independently constructed part of a filter. Shards allow
+       * construction to run in parallel for large key sets
+       */
+      template<class Fingerprint, class Layout>
+      struct Shard {
+         explicit Shard(const size_t& num_keys) : layout(num_keys), fingerprints(layout.size(), 0) {}
+
+         /**
+          * Remixes a key's hash with this shard's seed. Retrying with a different
+          * seed is necessary whenever peeling fails
+          */
+         forceinline HASH_64 remix(const HASH_64& hash) const {
+            return finalizer(hash + seed);
+         }
+
+         forceinline void prefetch(const HASH_64& h) const {
+            for (const auto& pos : layout.positions(h))
+               prefetchit(&fingerprints[pos], 0, 3);
+         }
+
+         forceinline bool matches(const HASH_64& h) const {
+            const auto pos = layout.positions(h);
+            return fingerprint(h) == (fingerprints[pos[0]] ^ fingerprints[pos[1]] ^ fingerprints[pos[2]]);
+         }
+
+         /**
+          * Constructs this shard from a list of (not remixed) key hashes
+          * @param hashes may be reordered and deduplicated
+          * @param initial_seed
+          */
+         void construct(std::vector<HASH_64>& hashes, const HASH_64& initial_seed) {
+            for (size_t attempt = 0; attempt < MaxAttempts; attempt++) {
+               seed = finalizer(initial_seed + attempt * 0x9E3779B97F4A7C15LLU);
+               if (peel(hashes))
+                  return;
+
+               // duplicate hashes (e.g., duplicate keys) can never be peeled.
+               // Since they map to the same fingerprint anyways, drop them
+               if (attempt == 0) {
+                  std::sort(hashes.begin(), hashes.end());
+                  hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+               }
+            }
+
+            throw std::runtime_error("failed to construct filter after " + std::to_string(MaxAttempts) + " attempts");
+         }
+
+         size_t byte_size() const {
+            return fingerprints.size() * sizeof(Fingerprint);
+         }
+
+        private:
+         static constexpr size_t MaxAttempts = 100;
+
+         const Layout layout;
+         const MurmurFinalizer<HASH_64> finalizer{};
+         HASH_64 seed = 0;
+         std::vector<Fingerprint> fingerprints;
+
+         static constexpr forceinline Fingerprint fingerprint(const HASH_64& h) {
+            return static_cast<Fingerprint>(h ^ (h >> 32));
+         }
+
+         /**
+          * Attempts to find a peeling order with the current seed and
+          * assigns fingerprints if successful
+          */
+         bool peel(const std::vector<HASH_64>& hashes) {
+            const auto size = layout.size();
+
+            // every slot tracks how many keys map to it and the xor of their hashes.
+            // Slots with exactly one key therefore directly reveal that key
+            std::vector<std::uint32_t> counts(size, 0);
+            std::vector<HASH_64> xors(size, 0);
+            for (const auto& hash : hashes) {
+               const auto h = remix(hash);
+               for (const auto& pos : layout.positions(h)) {
+                  counts[pos]++;
+                  xors[pos] ^= h;
+               }
+            }
+
+            std::vector<size_t> queue;
+            for (size_t pos = 0; pos < size; pos++)
+               if (counts[pos] == 1)
+                  queue.push_back(pos);
+
+            std::vector<std::pair<HASH_64, size_t>> stack;
+            stack.reserve(hashes.size());
+            while (!queue.empty()) {
+               const auto slot = queue.back();
+               queue.pop_back();
+               if (counts[slot] != 1)
+                  continue;
+
+               const auto h = xors[slot];
+               stack.emplace_back(h, slot);
+               for (const auto& pos : layout.positions(h)) {
+                  counts[pos]--;
+                  xors[pos] ^= h;
+                  if (counts[pos] == 1)
+                     queue.push_back(pos);
+               }
+            }
+
+            if (stack.size() != hashes.size())
+               return false;
+
+            // assign in reverse peeling order. The slot owned by a key is
+            // guaranteed to not be referenced by any key assigned afterwards
+            std::fill(fingerprints.begin(), fingerprints.end(), 0);
+            for (auto it = stack.rbegin(); it != stack.rend(); it++) {
+               const auto& [h, slot] = *it;
+               const auto pos = layout.positions(h);
+               fingerprints[slot] = fingerprint(h) ^ fingerprints[pos[0]] ^ fingerprints[pos[1]] ^ fingerprints[pos[2]];
+            }
+
+            return true;
+         }
+      };
+
+      /**
+       * Static membership filter from the xor filter family. Keys are hashed once
+       * with Hashfn. Large key sets are partitioned into shards based on this
+       * hash, which are then constructed in parallel.
+       *
+       * @tparam Key key type
+       * @tparam Hashfn hash function, should produce 64 bit hash values
+       * @tparam Fingerprint one of std::uint8_t (~0.4% false positives) or std::uint16_t (~0.0015%)
+       * @tparam Layout either XorLayout or BinaryFuseLayout
+       */
+      template<class Key, class Hashfn, class Fingerprint, class Layout, const char* BaseName>
+      struct XorFamilyFilter {
+         static_assert(std::is_same_v<Fingerprint, std::uint8_t> || std::is_same_v<Fingerprint, std::uint16_t>,
+                       "only 8 and 16 bit fingerprints are supported");
+
+         /**
+          * Constructs a filter containing all keys. May throw if construction fails,
+          * which is extremely unlikely for sets of distinct keys.
+          *
+          * @param keys
+          * @param num_threads amount of threads used for construction. Defaults to all hardware threads
+          * @param seed seed for remixing key hashes
+          */
+         explicit XorFamilyFilter(const std::vector<Key>& keys,
+                                  const size_t& num_threads = std::thread::hardware_concurrency(),
+                                  const HASH_64& seed = 0x238EF8E3LU)
+            : reductionfn(shard_count(keys.size())) {
+            const size_t threads = std::max(num_threads, static_cast<size_t>(1));
+            const size_t num_shards = shard_count(keys.size());
+
+            // partition hashes by shard
+            std::vector<std::vector<HASH_64>> partitions(num_shards);
+            if (num_shards == 1) {
+               partitions[0].resize(keys.size());
+               parallel_for(threads, keys.size(), [&](const size_t& begin, const size_t& end) {
+                  for (size_t i = begin; i < end; i++)
+                     partitions[0][i] = hashfn(keys[i]);
+               });
+            } else {
+               // count keys per shard & thread, then scatter. Hashing twice
+               // is cheaper than materializing all hashes once more
+               const size_t chunk = (keys.size() + threads - 1) / threads;
+               std::vector<std::vector<size_t>> offsets(threads, std::vector<size_t>(num_shards, 0));
+               parallel_for(threads, threads, [&](const size_t& begin, const size_t& end) {
+                  for (size_t t = begin; t < end; t++)
+                     for (size_t i = t * chunk; i < std::min((t + 1) * chunk, keys.size()); i++)
+                        offsets[t][shard_index(hashfn(keys[i]))]++;
+               });
+
+               for (size_t s = 0; s < num_shards; s++) {
+                  size_t total = 0;
+                  for (size_t t = 0; t < threads; t++) {
+                     const auto cnt = offsets[t][s];
+                     offsets[t][s] = total;
+                     total += cnt;
+                  }
+                  partitions[s].resize(total);
+               }
+
+               parallel_for(threads, threads, [&](const size_t& begin, const size_t& end) {
+                  for (size_t t = begin; t < end; t++) {
+                     for (size_t i = t * chunk; i < std::min((t + 1) * chunk, keys.size()); i++) {
+                        const HASH_64 hash = hashfn(keys[i]);
+                        const auto s = shard_index(hash);
+                        partitions[s][offsets[t][s]++] = hash;
+                     }
+                  }
+               });
+            }
+
+            // construct shards in parallel
+            shards.reserve(num_shards);
+            for (const auto& partition : partitions)
+               shards.emplace_back(partition.size());
+            parallel_for(threads, num_shards, [&](const size_t& begin, const size_t& end) {
+               for (size_t s = begin; s < end; s++) {
+                  shards[s].construct(partitions[s], seed + s);
+                  std::vector<HASH_64>().swap(partitions[s]);
+               }
+            });
+         }
+
+         static std::string name() {
+            return BaseName + std::to_string(sizeof(Fingerprint) * 8) + "_" + Hashfn::name();
+         }
+
+         forceinline bool contains(const Key& key) const {
+            const HASH_64 hash = hashfn(key);
+            const auto& shard = shards[shard_index(hash)];
+            return shard.matches(shard.remix(hash));
+         }
+
+         /**
+          * Looks up n keys and writes whether each key might be contained to result. All
+          * three fingerprints of each key in a small batch are prefetched ahead of time
+          */
+         void contains(const Key* keys, const size_t& n, bool* result) const {
+            std::array<const ShardType*, Batch> batch_shards;
+            std::array<HASH_64, Batch> batch_hashes;
+
+            for (size_t i = 0; i < n; i += Batch) {
+               const size_t cnt = std::min(Batch, n - i);
+               for (size_t j = 0; j < cnt; j++) {
+                  const HASH_64 hash = hashfn(keys[i + j]);
+                  batch_shards[j] = &shards[shard_index(hash)];
+                  batch_hashes[j] = batch_shards[j]->remix(hash);
+                  batch_shards[j]->prefetch(batch_hashes[j]);
+               }
+               for (size_t j = 0; j < cnt; j++)
+                  result[i + j] = batch_shards[j]->matches(batch_hashes[j]);
+            }
+         }
+
+         /**
+          * @return size of the filter in bytes
+          */
+         size_t byte_size() const {
+            size_t size = 0;
+            for (const auto& shard : shards)
+               size += shard.byte_size();
+            return size;
+         }
+
+        private:
+         using ShardType = Shard<Fingerprint, Layout>;
+
+         /// keys per shard. Large enough to not measurably impact space efficiency
+         static constexpr size_t ShardSize = 1LLU << 22;
+         /// amount of keys whose fingerprints are prefetched ahead of time
+         static constexpr size_t Batch = 16;
+
+         Hashfn hashfn;
+         const reduction::Fastrange<HASH_64> reductionfn;
+         std::vector<ShardType> shards;
+
+         static size_t shard_count(const size_t& num_keys) {
+            return std::max((num_keys + ShardSize - 1) / ShardSize, static_cast<size_t>(1));
+         }
+
+         forceinline size_t shard_index(const HASH_64& hash) const {
+            return reductionfn(hash);
+         }
+
+         /**
+          * Splits [0, n) into equally sized ranges processed by up to num_threads threads.
+          * Exceptions are propagated to the caller
+          */
+         template<class Fn>
+         static void parallel_for(const size_t& num_threads, const size_t& n, const Fn& fn) {
+            const size_t threads = std::min(num_threads, std::max(n, static_cast<size_t>(1)));
+            if (threads <= 1) {
+               fn(0, n);
+               return;
+            }
+
+            const size_t chunk = (n + threads - 1) / threads;
+            std::vector<std::exception_ptr> errors(threads);
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (size_t t = 0; t < threads; t++) {
+               workers.emplace_back([&, t] {
+                  try {
+                     fn(std::min(t * chunk, n), std::min((t + 1) * chunk, n));
+                  } catch (...) {
+                     errors[t] = std::current_exception();
+                  }
+               });
+            }
+            for (auto& worker : workers)
+               worker.join();
+            for (const auto& error : errors)
+               if (error)
+                  std::rethrow_exception(error);
+         }
+      };
+
+      const char XOR_FILTER[] = "xor";
+      const char BINARY_FUSE_FILTER[] = "binary_fuse";
+   } // namespace _
+
+   /// Xor filter with configurable fingerprint width
+   template<class Key, class Hashfn, class Fingerprint = std::uint8_t>
+   using XorFilter = _::XorFamilyFilter<Key, Hashfn, Fingerprint, _::XorLayout, _::XOR_FILTER>;
+   /// Xor filter with 8-bit fingerprints, ~9.84 bits per key
+   template<class Key, class Hashfn>
+   using XorFilter8 = XorFilter<Key, Hashfn, std::uint8_t>;
+   /// Xor filter with 16-bit fingerprints, ~19.7 bits per key
+   template<class Key, class Hashfn>
+   using XorFilter16 = XorFilter<Key, Hashfn, std::uint16_t>;
+
+   /// Binary fuse filter with configurable fingerprint width
+   template<class Key, class Hashfn, class Fingerprint = std::uint8_t>
+   using BinaryFuseFilter = _::XorFamilyFilter<Key, Hashfn, Fingerprint, _::BinaryFuseLayout, _::BINARY_FUSE_FILTER>;
+   /// Binary fuse filter with 8-bit fingerprints, ~9 bits per key
+   template<class Key, class Hashfn>
+   using BinaryFuse8 = BinaryFuseFilter<Key, Hashfn, std::uint8_t>;
+   /// Binary fuse filter with 16-bit fingerprints, ~18 bits per key
+   template<class Key, class Hashfn>
+   using BinaryFuse16 = BinaryFuseFilter<Key, Hashfn, std::uint16_t>;
+} // namespace hashing::filter
@@ -28,9 +28,15 @@
 #pragma once
 
 #include "./convenience/builtins.hpp"
+#include "./dispatch.hpp"
 #include "./reduction.hpp"
 
+#include <algorithm>
 #include <array>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace hashing {
 #define MEOW_HASH_VERSION 5
@@ -143,8 +149,36 @@ namespace hashing {
    #define MEOW_DUMP_STATE(...)
 #endif
 
+   template<class Result>
+   struct MeowHashStream;
+
    struct MeowHash {
+      // shares the streaming construction below
+      template<class Result>
+      friend struct MeowHashStream;
+
      protected:
+      using Seed = std::array<meow_u8, 128>;
+
+      /**
+       * @return copy of the default seed
+       */
+      static Seed default_seed() {
+         Seed res;
+         std::copy(std::begin(MeowDefaultSeed), std::end(MeowDefaultSeed), res.begin());
+         return res;
+      }
+
+      /**
+       * Expands a 64-bit seed into a full 128 byte seed. This is expensive and
+       * should therefore only happen once per seed, e.g., on construction
+       */
+      static target_sse42aes Seed expand_seed(HASH_64 seed) {
+         Seed res;
+         MeowExpandSeed(sizeof(seed), &seed, res.data());
+         return res;
+      }
+
       /**
     * Obtain 128 bit meowhash value
     *
@@ -154,9 +188,21 @@ namespace hashing {
     * @return
     */
       template<typename T>
-      static forceinline meow_u128 hash(const T& value,
+      static forceinline_sse42aes meow_u128 hash(const T& value,
                                         const meow_u8 seed[128] = const_cast<unsigned char*>(MeowDefaultSeed));
 
+      /**
+    * Obtain 128 bit meowhash value of arbitrary bytes
+    *
+    * @param key
+    * @param seed
+    * @return
+    */
+      static forceinline_sse42aes meow_u128 hash(const std::string_view& key,
+                                        const meow_u8 seed[128] = const_cast<unsigned char*>(MeowDefaultSeed)) {
+         return _hash(reinterpret_cast<const void*>(seed), key.size(), reinterpret_cast<const void*>(key.data()));
+      }
+
      private:
       constexpr static const meow_u8 MeowShiftAdjust[32] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
                                                             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
@@ -179,7 +225,7 @@ namespace hashing {
       // NOTE(casey): Single block version
       //
 
-      static forceinline meow_u128 _hash(const void* Seed128Init, const meow_umm& Len, const void* SourceInit) {
+      static forceinline_sse42aes meow_u128 _hash(const void* Seed128Init, const meow_umm& Len, const void* SourceInit) {
          meow_u128 xmm0, xmm1, xmm2, xmm3, xmm4, xmm5, xmm6,
             xmm7; // NOTE(casey): xmm0-xmm7 are the hash accumulation lanes
          meow_u128 xmm8, xmm9, xmm10, xmm11, xmm12, xmm13, xmm14,
@@ -396,7 +442,7 @@ namespace hashing {
          meow_u128 Pad[2]; // NOTE(casey): So we know we can over-read Buffer as necessary
       };
 
-      static void MeowBegin(meow_state* State, void* Seed128) {
+      static target_sse42aes void MeowBegin(meow_state* State, void* Seed128) {
          meow_u8* rcx = static_cast<meow_u8*>(Seed128);
 
          movdqu(State->xmm0, rcx + 0x00);
@@ -415,7 +461,7 @@ namespace hashing {
          State->TotalLengthInBytes = 0;
       }
 
-      static void MeowAbsorbBlocks(meow_state* State, meow_umm BlockCount, meow_u8* rax) {
+      static target_sse42aes void MeowAbsorbBlocks(meow_state* State, meow_umm BlockCount, meow_u8* rax) {
          meow_u128 xmm0 = State->xmm0;
          meow_u128 xmm1 = State->xmm1;
          meow_u128 xmm2 = State->xmm2;
@@ -468,7 +514,7 @@ namespace hashing {
          State->xmm7 = xmm7;
       }
 
-      static void MeowAbsorb(meow_state* State, meow_umm Len, void* SourceInit) {
+      static target_sse42aes void MeowAbsorb(meow_state* State, meow_umm Len, void* SourceInit) {
          State->TotalLengthInBytes += Len;
          meow_u8* Source = static_cast<meow_u8*>(SourceInit);
 
@@ -504,7 +550,7 @@ namespace hashing {
          }
       }
 
-      static meow_u128 MeowEnd(meow_state* State, meow_u8* Store128) {
+      static target_sse42aes meow_u128 MeowEnd(meow_state* State, meow_u8* Store128) {
          meow_umm Len = State->TotalLengthInBytes;
 
          meow_u128 xmm0 = State->xmm0;
@@ -664,7 +710,7 @@ namespace hashing {
       // need to create a new seed.
       //
 
-      static void MeowExpandSeed(meow_umm InputLen, void* Input, meow_u8* SeedResult) {
+      static target_sse42aes void MeowExpandSeed(meow_umm InputLen, void* Input, meow_u8* SeedResult) {
          meow_state State;
          meow_u64 LengthTab = (meow_u64)
             InputLen; // NOTE(casey): We need to always injest 8-byte lengths exactly, even on 32-bit builds, to ensure identical results
@@ -680,21 +726,36 @@ namespace hashing {
    };
 
    template<>
-   forceinline meow_u128 MeowHash::hash(const HASH_32& value, const meow_u8 seed[128]) {
+   forceinline_sse42aes meow_u128 MeowHash::hash(const HASH_32& value, const meow_u8 seed[128]) {
       std::array<uint32_t, 4> dat{};
       dat.fill(value);
       return _hash(reinterpret_cast<const void*>(seed), sizeof(HASH_32), reinterpret_cast<const void*>(&dat));
    }
 
    template<>
-   forceinline meow_u128 MeowHash::hash(const HASH_64& value, const meow_u8 seed[128]) {
+   forceinline_sse42aes meow_u128 MeowHash::hash(const HASH_64& value, const meow_u8 seed[128]) {
       std::array<uint64_t, 2> dat{};
       dat.fill(value);
       return _hash(reinterpret_cast<const void*>(seed), sizeof(HASH_64), reinterpret_cast<const void*>(&dat));
    }
 
+   template<>
+   forceinline_sse42aes meow_u128 MeowHash::hash(const HASH_128& value, const meow_u8 seed[128]) {
+      return _hash(reinterpret_cast<const void*>(seed), sizeof(HASH_128), reinterpret_cast<const void*>(&value));
+   }
+
    template<class T, unsigned int select = 0>
    struct MeowHash32 : private MeowHash {
+      /// requires AES-NI, may only be executed if dispatch::supported<MeowHash32>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      MeowHash32() : seed(default_seed()) {}
+
+      /**
+       * @param seed expanded into a full meow seed once, using MeowExpandSeed
+       */
+      explicit MeowHash32(const HASH_64& seed) : seed(expand_seed(seed)) {}
+
       static std::string name() {
          return "meow32";
       }
@@ -708,12 +769,29 @@ namespace hashing {
     * @param seed
     * @return
     */
-      forceinline HASH_32 operator()(const T& data) const {
-         return reduction::extract_32<select>(hash(data));
+      forceinline_sse42aes HASH_32 operator()(const T& data) const {
+         return reduction::extract_32<select>(hash(data, seed.data()));
+      }
+
+      forceinline_sse42aes HASH_32 operator()(const std::string_view& key) const {
+         return reduction::extract_32<select>(hash(key, seed.data()));
       }
+
+     private:
+      Seed seed;
    };
    template<class T, unsigned int select = 0>
    struct MeowHash64 : private MeowHash {
+      /// requires AES-NI, may only be executed if dispatch::supported<MeowHash64>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      MeowHash64() : seed(default_seed()) {}
+
+      /**
+       * @param seed expanded into a full meow seed once, using MeowExpandSeed
+       */
+      explicit MeowHash64(const HASH_64& seed) : seed(expand_seed(seed)) {}
+
       static std::string name() {
          return "meow64" + std::string(select == 0 ? "_low" : "_upp");
       }
@@ -727,21 +805,105 @@ namespace hashing {
     * @param seed
     * @return
     */
-      forceinline HASH_64 operator()(const T& data) const {
-         return reduction::extract_64<select>(hash(data));
+      forceinline_sse42aes HASH_64 operator()(const T& data) const {
+         return reduction::extract_64<select>(hash(data, seed.data()));
+      }
+
+      forceinline_sse42aes HASH_64 operator()(const std::string_view& key) const {
+         return reduction::extract_64<select>(hash(key, seed.data()));
       }
+
+     private:
+      Seed seed;
    };
 
    template<class T, unsigned int select = 0>
    struct MeowHash128 : private MeowHash {
+      /// requires AES-NI, may only be executed if dispatch::supported<MeowHash128>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      MeowHash128() : seed(default_seed()) {}
+
+      /**
+       * @param seed expanded into a full meow seed once, using MeowExpandSeed
+       */
+      explicit MeowHash128(const HASH_64& seed) : seed(expand_seed(seed)) {}
+
       static std::string name() {
          return "meow128";
       }
 
-      forceinline HASH_128 operator()(const T& key) const {
-         const auto h = hash(key);
+      forceinline_sse42aes HASH_128 operator()(const T& key) const {
+         const auto h = hash(key, seed.data());
+         return static_cast<HASH_128>(reduction::extract_64<0>(h)) |
+            (static_cast<HASH_128>(reduction::extract_64<1>(h)) << 64);
+      }
+
+      forceinline_sse42aes HASH_128 operator()(const std::string_view& key) const {
+         const auto h = hash(key, seed.data());
          return static_cast<HASH_128>(reduction::extract_64<0>(h)) |
             (static_cast<HASH_128>(reduction::extract_64<1>(h)) << 64);
       }
+
+     private:
+      Seed seed;
+   };
+
+   /**
+    * Incremental MeowHash, i.e., input may be appended in arbitrarily sized chunks. The
+    * digest is identical to MeowHash64<T, 0> (HASH_64) or MeowHash128 (HASH_128) of the
+    * concatenated input. Input is buffered in 256 byte blocks
+    *
+    * @tparam Result digest type, either HASH_64 or HASH_128
+    */
+   template<class Result = HASH_64>
+   struct MeowHashStream {
+      static_assert(std::is_same_v<Result, HASH_64> || std::is_same_v<Result, HASH_128>,
+                    "meow digests are either 64 or 128 bits wide");
+
+      /// requires AES-NI, may only be executed if dispatch::supported<MeowHashStream>()
+      static constexpr dispatch::Level min_level = dispatch::Level::SSE42_AES;
+
+      using Digest = Result;
+
+      static std::string name() {
+         return "meow_stream_" + std::to_string(sizeof(Result) * 8);
+      }
+
+      MeowHashStream() {
+         reset();
+      }
+
+      /**
+       * discards all previously appended input
+       */
+      target_sse42aes void reset() {
+         MeowHash::MeowBegin(&state, const_cast<meow_u8*>(MeowHash::MeowDefaultSeed));
+      }
+
+      target_sse42aes void update(const void* data, const size_t& len) {
+         MeowHash::MeowAbsorb(&state, len, const_cast<void*>(data));
+      }
+
+      target_sse42aes void update(const std::string_view& data) {
+         update(data.data(), data.size());
+      }
+
+      /**
+       * @return hash of all input appended since the last reset. Does not modify the state,
+       *    i.e., more input may be appended afterwards
+       */
+      target_sse42aes Digest digest() const {
+         // MeowEnd only reads the state
+         const auto h = MeowHash::MeowEnd(const_cast<MeowHash::meow_state*>(&state), nullptr);
+         if constexpr (std::is_same_v<Result, HASH_64>)
+            return reduction::extract_64<0>(h);
+         else
+            return static_cast<HASH_128>(reduction::extract_64<0>(h)) |
+               (static_cast<HASH_128>(reduction::extract_64<1>(h)) << 64);
+      }
+
+     private:
+      MeowHash::meow_state state;
    };
 } // namespace hashing
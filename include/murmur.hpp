@@ -10,8 +10,11 @@
 
 #pragma once
 
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "convenience/builtins.hpp"
 #include "types.hpp"
@@ -23,11 +26,22 @@ namespace hashing {
          return "murmur_finalizer" + std::to_string(sizeof(T) * 8);
       }
 
+      /**
+       * @param seed xored into each key before mixing. Since the finalizer is a bijection,
+       *    differently seeded instances are distinct permutations of the key space. The
+       *    default seed 0 yields the original finalizer
+       */
+      constexpr explicit MurmurFinalizer(const T& seed = 0) : seed(seed) {}
+
       constexpr forceinline T operator()(T key) const;
+
+     private:
+      T seed;
    };
 
    template<>
    constexpr HASH_32 MurmurFinalizer<HASH_32>::operator()(HASH_32 key) const {
+      key ^= seed;
       key ^= key >> 16;
       key *= 0x85ebca6bLU;
       key ^= key >> 13;
@@ -39,6 +53,7 @@ namespace hashing {
 
    template<>
    constexpr HASH_64 MurmurFinalizer<HASH_64>::operator()(HASH_64 key) const {
+      key ^= seed;
       key ^= key >> 33;
       key *= 0xff51afd7ed558ccdLLU;
       key ^= key >> 33;
@@ -48,20 +63,38 @@ namespace hashing {
       return key;
    }
 
+   /**
+    * Applies the 64-bit finalizer to both halves, feeding the first result into the second
+    * and back. Every step is invertible, i.e., this is a bijection on 128-bit keys
+    */
+   template<>
+   constexpr HASH_128 MurmurFinalizer<HASH_128>::operator()(HASH_128 key) const {
+      const MurmurFinalizer<HASH_64> fmix;
+
+      key ^= seed;
+      HASH_64 low = fmix(static_cast<HASH_64>(key));
+      const HASH_64 high = fmix(static_cast<HASH_64>(key >> 64) ^ low);
+      low += high;
+
+      return to_hash128(high, low);
+   }
+
    /**
  * Murmur3 32-bit, adjusted to fixed 32-bit input values (compiler would presumably perform the same optimizations.
  * However, in this explicit form it is clear what computation actually happens. This might be important for the
  * argument "VLDB paper misrepresents murmur quality, here's what murmur actually computes:").
  *
- * @tparam seed murmur seed, defaults to 0x238EF8E3 (random 32-bit prime)
+ * @tparam default_seed murmur seed of default constructed instances, defaults to 0x238EF8E3 (random 32-bit prime)
  * @return
  */
-   template<const HASH_32 seed = 0x238EF8E3LU>
+   template<const HASH_32 default_seed = 0x238EF8E3LU>
    struct Murmur3Hash32 {
       static std::string name() {
          return "murmur3_32";
       }
 
+      constexpr explicit Murmur3Hash32(const HASH_32& seed = default_seed) : seed(seed) {}
+
       constexpr forceinline HASH_32 operator()(const HASH_32& key) const {
          const auto len = sizeof(HASH_32);
 
@@ -87,7 +120,7 @@ namespace hashing {
 
          h1 ^= k1;
          h1 = rotl32(h1, 13);
-         h1 = h1 * 5 * 0xe6546b64;
+         h1 = h1 * 5 + 0xe6546b64;
 
          //----------
          // tail
@@ -99,7 +132,63 @@ namespace hashing {
          return finalizer(h1 ^ len);
       }
 
+      forceinline HASH_32 operator()(const std::string_view& key) const {
+         const auto rotl32 = [](uint32_t x, int8_t r) { return (x << r) | (x >> (32 - r)); };
+
+         const auto* data = reinterpret_cast<const uint8_t*>(key.data());
+         const size_t len = key.size();
+         const size_t nblocks = len / 4;
+
+         uint32_t h1 = seed;
+
+         const uint32_t c1 = 0xcc9e2d51;
+         const uint32_t c2 = 0x1b873593;
+
+         //----------
+         // body
+
+         for (size_t i = 0; i < nblocks; i++) {
+            uint32_t k1;
+            std::memcpy(&k1, data + i * 4, sizeof(k1));
+
+            k1 *= c1;
+            k1 = rotl32(k1, 15);
+            k1 *= c2;
+
+            h1 ^= k1;
+            h1 = rotl32(h1, 13);
+            h1 = h1 * 5 + 0xe6546b64;
+         }
+
+         //----------
+         // tail
+
+         const uint8_t* tail = data + nblocks * 4;
+
+         uint32_t k1 = 0;
+
+         switch (len & 3) {
+            case 3:
+               k1 ^= tail[2] << 16;
+               [[fallthrough]];
+            case 2:
+               k1 ^= tail[1] << 8;
+               [[fallthrough]];
+            case 1:
+               k1 ^= tail[0];
+               k1 *= c1;
+               k1 = rotl32(k1, 15);
+               k1 *= c2;
+               h1 ^= k1;
+         };
+
+         //----------
+         // finalizer
+         return finalizer(h1 ^ static_cast<uint32_t>(len));
+      }
+
      private:
+      HASH_32 seed;
       MurmurFinalizer<HASH_32> finalizer;
    };
 
@@ -109,20 +198,20 @@ namespace hashing {
     * argument "VLDB paper misrepresents murmur quality, here's what murmur actually computes:").
     *
     * @param value
-    * @param seed murmur seed, defaults to 0xC7455FEC83DD661F (random 64-bit prime)
+    * @tparam default_seed murmur seed of default constructed instances, defaults to 0xC7455FEC83DD661F (random 64-bit prime)
     * @return
     */
-   template<const HASH_64 seed = 0xC7455FEC83DD661FLLU>
+   template<const HASH_64 default_seed = 0xC7455FEC83DD661FLLU>
    struct Murmur3Hash128 {
       static std::string name() {
          return "murmur3_128";
       }
 
+      constexpr explicit Murmur3Hash128(const HASH_64& seed = default_seed) : seed(seed) {}
+
       constexpr forceinline HASH_128 operator()(const void* data, const size_t& len) const {
          // Helper functions (inline for inlining)
-         const auto getblock32 = [](const uint32_t* p, int i) { return p[i]; };
          const auto getblock64 = [](const uint64_t* p, int i) { return p[i]; };
-         const auto rotl32 = [](uint32_t x, int8_t r) { return (x << r) | (x >> (32 - r)); };
          const auto rotl64 = [](uint64_t x, int8_t r) { return (x << r) | (x >> (64 - r)); };
 
          //const auto* bytes = static_cast<const uint8_t*>(data);
@@ -173,37 +262,50 @@ namespace hashing {
          switch (len & 15) {
             case 15:
                k2 ^= (static_cast<uint64_t>(tail[14])) << 48;
+               [[fallthrough]];
             case 14:
                k2 ^= (static_cast<uint64_t>(tail[13])) << 40;
+               [[fallthrough]];
             case 13:
                k2 ^= (static_cast<uint64_t>(tail[12])) << 32;
+               [[fallthrough]];
             case 12:
                k2 ^= (static_cast<uint64_t>(tail[11])) << 24;
+               [[fallthrough]];
             case 11:
                k2 ^= (static_cast<uint64_t>(tail[10])) << 16;
+               [[fallthrough]];
             case 10:
                k2 ^= (static_cast<uint64_t>(tail[9])) << 8;
+               [[fallthrough]];
             case 9:
                k2 ^= (static_cast<uint64_t>(tail[8])) << 0;
                k2 *= c2;
                k2 = rotl64(k2, 33);
                k2 *= c1;
                h2 ^= k2;
-
+               [[fallthrough]];
             case 8:
                k1 ^= (static_cast<uint64_t>(tail[7])) << 56;
+               [[fallthrough]];
             case 7:
                k1 ^= (static_cast<uint64_t>(tail[6])) << 48;
+               [[fallthrough]];
             case 6:
                k1 ^= (static_cast<uint64_t>(tail[5])) << 40;
+               [[fallthrough]];
             case 5:
                k1 ^= (static_cast<uint64_t>(tail[4])) << 32;
+               [[fallthrough]];
             case 4:
                k1 ^= (static_cast<uint64_t>(tail[3])) << 24;
+               [[fallthrough]];
             case 3:
                k1 ^= (static_cast<uint64_t>(tail[2])) << 16;
+               [[fallthrough]];
             case 2:
                k1 ^= (static_cast<uint64_t>(tail[1])) << 8;
+               [[fallthrough]];
             case 1:
                k1 ^= (static_cast<uint64_t>(tail[0])) << 0;
                k1 *= c1;
@@ -230,6 +332,19 @@ namespace hashing {
          return to_hash128(h2, h1);
       }
 
+      forceinline HASH_128 operator()(const std::string_view& key) const {
+         return (*this)(key.data(), key.size());
+      }
+
+      /**
+       * 128-bit keys, i.e., a single 16 byte block. Templated to not render calls with
+       * narrower integers ambiguous
+       */
+      template<class K, std::enable_if_t<std::is_same_v<K, HASH_128>, bool> = true>
+      forceinline HASH_128 operator()(const K& key) const {
+         return (*this)(&key, sizeof(K));
+      }
+
       constexpr forceinline HASH_128 operator()(const HASH_64& key) const {
          // nblocks = len / 16 = sizeof(value) / 16  = 8 / 16 = 0 (int division)
 
@@ -285,10 +400,11 @@ namespace hashing {
          h1 += h2;
          h2 += h1;
 
-         return to_hash128(h1, h2);
+         return to_hash128(h2, h1);
       }
 
      private:
+      HASH_64 seed;
       MurmurFinalizer<HASH_64> finalizer;
    };
 } // namespace hashing
@@ -341,7 +341,8 @@ namespace hashing::reduction {
    };
 
    /**
-    * Extract 32 bits using __mm_extract_epi32
+    * Extract 32 bits of a 128-bit register. Only requires SSE2, compilers
+    * emit pextrd if SSE4.1 is available
     *
     * @tparam A
     * @tparam select bit offset according to formula select * 32. Defaults to 0
@@ -350,11 +351,12 @@ namespace hashing::reduction {
     */
    template<uint8_t select = 0, typename A>
    static constexpr forceinline HASH_32 extract_32(const A& a) {
-      return _mm_extract_epi32(a, select);
+      return _mm_cvtsi128_si32(_mm_srli_si128(a, 4 * select));
    }
 
    /**
-    * Extract 64 bits using __mm_extract_epi64
+    * Extract 64 bits of a 128-bit register. Only requires SSE2, compilers
+    * emit pextrq if SSE4.1 is available
     *
     * @tparam A
     * @tparam select either 0 or 1 (low/high selection). Defaults to 0
@@ -363,7 +365,7 @@ namespace hashing::reduction {
     */
    template<uint8_t select = 0, typename A>
    static constexpr forceinline HASH_64 extract_64(const A& a) {
-      return _mm_extract_epi64(a, select);
+      return _mm_cvtsi128_si64(_mm_srli_si128(a, 8 * select));
    }
 }; // namespace hashing::reduction
 
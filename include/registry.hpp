@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "aqua.hpp"
+#include "city.hpp"
+#include "dispatch.hpp"
+#include "meow.hpp"
+#include "mult.hpp"
+#include "murmur.hpp"
+#include "reduction.hpp"
+#include "tabulation.hpp"
+#include "types.hpp"
+#include "xxh.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::registry {
+   /**
+    * Type erased batch hash function, hashing n keys into 64-bit hash values
+    */
+   template<class Key>
+   using BatchFn = std::function<void(const Key* keys, size_t n, HASH_64* out)>;
+
+   /**
+    * Type erased batch reduction function, reducing n 64-bit hash values to [0, N)
+    */
+   using BatchReducerFn = std::function<void(const HASH_64* hashes, size_t n, HASH_64* out)>;
+
+   namespace _ {
+      template<class Result>
+      static constexpr forceinline HASH_64 widen(const Result& hash) {
+         if constexpr (std::is_same_v<Result, HASH_128>)
+            return reduction::hash_128_to_64(hash);
+         else
+            return static_cast<HASH_64>(hash);
+      }
+
+      /**
+       * wraps a runtime dispatched BatchHasher. Functions whose result is not 64 bits
+       * wide are hashed into a small stack buffer which is converted afterwards
+       */
+      template<class Key, class Hashfn>
+      BatchFn<Key> erase(const Hashfn& hashfn) {
+         using Hasher = dispatch::BatchHasher<Key, Hashfn>;
+         using Result = typename Hasher::Result;
+         const Hasher hasher(hashfn);
+
+         if constexpr (std::is_same_v<Result, HASH_64>) {
+            return [hasher](const Key* keys, size_t n, HASH_64* out) { hasher(keys, n, out); };
+         } else {
+            return [hasher](const Key* keys, size_t n, HASH_64* out) {
+               constexpr size_t Chunk = 256;
+               std::array<Result, Chunk> buffer;
+               for (size_t i = 0; i < n; i += Chunk) {
+                  const size_t cnt = std::min(Chunk, n - i);
+                  hasher(keys + i, cnt, buffer.data());
+                  for (size_t j = 0; j < cnt; j++)
+                     out[i + j] = widen(buffer[j]);
+               }
+            };
+         }
+      }
+
+      template<class T, template<class> class Reducer>
+      BatchReducerFn erase_reducer(const size_t& N) {
+         return [reducer = Reducer<T>(N)](const HASH_64* hashes, size_t n, HASH_64* out) {
+            for (size_t i = 0; i < n; i++)
+               out[i] = reducer(static_cast<T>(hashes[i]));
+         };
+      }
+
+      template<class T>
+      std::vector<std::string> range_reducer_names() {
+         return {reduction::Modulo<T>::name(), reduction::FastModulo<T>::name(),
+                 reduction::BranchlessFastModulo<T>::name(), reduction::Fastrange<T>::name()};
+      }
+
+      template<class T>
+      std::vector<std::string> reducer_names() {
+         auto res = range_reducer_names<T>();
+         res.insert(res.begin(), reduction::DoNothing<T>::name());
+         return res;
+      }
+
+      /**
+       * @return reducer operating on T called name or an empty function if there is none
+       */
+      template<class T>
+      BatchReducerFn make_reducer(const std::string& name, const size_t& N) {
+         if (name == reduction::DoNothing<T>::name())
+            return erase_reducer<T, reduction::DoNothing>(N);
+         if (name == reduction::Modulo<T>::name())
+            return erase_reducer<T, reduction::Modulo>(N);
+         if (name == reduction::FastModulo<T>::name())
+            return erase_reducer<T, reduction::FastModulo>(N);
+         if (name == reduction::BranchlessFastModulo<T>::name())
+            return erase_reducer<T, reduction::BranchlessFastModulo>(N);
+         if (name == reduction::Fastrange<T>::name())
+            return erase_reducer<T, reduction::Fastrange>(N);
+         return {};
+      }
+   } // namespace _
+
+   /**
+    * Maps hash function names, i.e., Hashfn::name(), to type erased batch hash
+    * functions. Selecting a function by name costs one lookup, each call thereafter
+    * a single indirect call per batch of keys.
+    *
+    * @tparam Key key type
+    */
+   template<class Key>
+   struct Registry {
+      /**
+       * Registers Hashfn under Hashfn::name(). Functions not supported by
+       * this cpu (see dispatch::supported) are skipped
+       *
+       * @return whether the function was registered
+       */
+      template<class Hashfn>
+      bool add(const Hashfn& hashfn = Hashfn()) {
+         if (!dispatch::supported<Hashfn>())
+            return false;
+         // 128-bit results are folded into 64 bits (see _::widen)
+         add(Hashfn::name(), _::erase<Key>(hashfn), std::min(dispatch::output_bits<Hashfn, Key>(), static_cast<size_t>(64)));
+         return true;
+      }
+
+      /**
+       * Registers a custom batch hash function
+       * @param bits amount of low bits of each hash value fn may set, i.e., 32 or 64
+       * @throws std::invalid_argument if name is already taken
+       */
+      void add(const std::string& name, BatchFn<Key> fn, const size_t& bits = 64) {
+         if (!functions.emplace(name, Entry{std::move(fn), bits}).second)
+            throw std::invalid_argument("hash function '" + name + "' is already registered");
+      }
+
+      /**
+       * @throws std::out_of_range if no function is registered under name
+       */
+      const BatchFn<Key>& get(const std::string& name) const {
+         const auto it = functions.find(name);
+         if (it == functions.end())
+            throw std::out_of_range("unknown hash function '" + name + "'");
+         return it->second.fn;
+      }
+
+      /**
+       * Output width of a registered function. Functions producing 32-bit hashes must be
+       * paired with 32-bit reducers, e.g., fastrange64 maps all of their hashes to 0
+       *
+       * @return 32 or 64
+       * @throws std::out_of_range if no function is registered under name
+       */
+      size_t bits(const std::string& name) const {
+         const auto it = functions.find(name);
+         if (it == functions.end())
+            throw std::out_of_range("unknown hash function '" + name + "'");
+         return it->second.bits;
+      }
+
+      bool contains(const std::string& name) const {
+         return functions.find(name) != functions.end();
+      }
+
+      /**
+       * @return names of all registered functions in lexicographic order
+       */
+      std::vector<std::string> names() const {
+         std::vector<std::string> res;
+         res.reserve(functions.size());
+         for (const auto& [name, _] : functions)
+            res.push_back(name);
+         return res;
+      }
+
+      /**
+       * @return registry containing all hash functions of this library that
+       *    accept Key and are supported by this cpu
+       */
+      static const Registry& defaults() {
+         static_assert(std::is_same_v<Key, HASH_32> || std::is_same_v<Key, HASH_64> || std::is_same_v<Key, HASH_128>,
+                       "default registry is only available for 32, 64 and 128 bit keys");
+
+         static const Registry registry = [] {
+            Registry r;
+            r.template add<MurmurFinalizer<Key>>();
+            r.template add<XXHash3<Key>>();
+            r.template add<XXHash32<Key>>();
+            r.template add<XXHash64<Key>>();
+            r.template add<XXHash3_128<Key>>();
+            r.template add<AquaHash<Key>>();
+            r.template add<MeowHash32<Key>>();
+            r.template add<MeowHash64<Key>>();
+            r.template add<MeowHash128<Key>>();
+            r.template add<CityHash32<Key>>();
+            r.template add<CityHash64<Key>>();
+            r.template add<CityHash128<Key>>();
+
+            if constexpr (std::is_same_v<Key, HASH_32>) {
+               r.template add<TabulationHash<Key>>();
+               r.template add<Murmur3Hash32<>>();
+               r.template add<MultPrime32>();
+               r.template add<Fibonacci32>();
+               r.template add<FibonacciPrime32>();
+            } else if constexpr (std::is_same_v<Key, HASH_64>) {
+               r.template add<TabulationHash<Key>>();
+               r.template add<AquaHash<Key, 1>>();
+               r.template add<MeowHash64<Key, 1>>();
+               r.template add<MultPrime64>();
+               r.template add<Fibonacci64>();
+               r.template add<FibonacciPrime64>();
+            } else {
+               r.template add<Murmur3Hash128<>>();
+               r.template add<MeowHash64<Key, 1>>();
+            }
+            return r;
+         }();
+         return registry;
+      }
+
+     private:
+      struct Entry {
+         BatchFn<Key> fn;
+         size_t bits;
+      };
+      std::map<std::string, Entry> functions;
+   };
+
+   /**
+    * @return names accepted by make_reducer
+    */
+   inline std::vector<std::string> reducer_names() {
+      std::vector<std::string> res;
+      for (const auto& names : {_::reducer_names<HASH_32>(), _::reducer_names<HASH_64>()})
+         res.insert(res.end(), names.begin(), names.end());
+      return res;
+   }
+
+   /**
+    * @return names of the reducers mapping hashes of the given width (see Registry::bits)
+    *    to [0, N), i.e., excluding do_nothing
+    */
+   inline std::vector<std::string> range_reducer_names(const size_t& hash_bits) {
+      return hash_bits <= 32 ? _::range_reducer_names<HASH_32>() : _::range_reducer_names<HASH_64>();
+   }
+
+   /**
+    * Instantiates a type erased batch reducer by name, e.g., "fastrange64". 32-bit
+    * reducers, e.g., "fastrange32", only consider the lower 32 bits of each hash and
+    * are therefore meant for functions producing 32-bit hashes
+    *
+    * @param name reducer name, i.e., Reducer::name()
+    * @param N reduce hashes to [0, N)
+    * @throws std::out_of_range if no reducer with the given name exists
+    */
+   inline BatchReducerFn make_reducer(const std::string& name, const size_t& N) {
+      if (auto fn = _::make_reducer<HASH_64>(name, N))
+         return fn;
+      if (auto fn = _::make_reducer<HASH_32>(name, N))
+         return fn;
+
+      throw std::out_of_range("unknown reducer '" + name + "'");
+   }
+} // namespace hashing::registry
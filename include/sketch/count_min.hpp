@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "../dispatch.hpp"
+#include "../murmur.hpp"
+#include "../tabulation.hpp"
+#include "../types.hpp"
+
+// Order important
+#include "../convenience/builtins.hpp"
+
+namespace hashing::sketch {
+   namespace _ {
+      /**
+       * d independent row hash functions, each instantiated with a different seed.
+       * Hashfn must therefore be constructible from a 64-bit seed, e.g., TabulationHash
+       */
+      template<class Key, class Hashfn, const size_t d>
+      struct Rows {
+         static_assert(d > 0, "sketch must have at least one row");
+         static_assert(std::is_constructible_v<Hashfn, HASH_64>,
+                       "row hash functions must be constructible from a runtime seed");
+
+         /// amount of keys whose counters are prefetched ahead of time
+         static constexpr size_t Batch = 16;
+
+         Rows(const size_t& width, const HASH_64& seed)
+            : width(width), rows(make_rows(seed, std::make_index_sequence<d>{})) {
+            if (width == 0 || width > std::numeric_limits<HASH_32>::max())
+               throw std::runtime_error("sketch width " + std::to_string(width) + " is not supported");
+         }
+
+         /**
+          * @return position of key's counter in row, i.e., in [row * width, (row + 1) * width)
+          */
+         forceinline size_t index(const Key& key, const size_t& row) const {
+            bool sign;
+            return index(key, row, sign);
+         }
+
+         /**
+          * @param sign whether key is counted positively in row. Only used by count sketch
+          * @return position of key's counter in row, i.e., in [row * width, (row + 1) * width)
+          */
+         forceinline size_t index(const Key& key, const size_t& row, bool& sign) const {
+            const auto hash = rows[row](key);
+            sign = hash & 0x1;
+            return row * width + ((static_cast<HASH_64>(reduction_bits(hash)) * width) >> 32);
+         }
+
+         /**
+          * computes the counter positions of cnt <= Batch keys in all d rows,
+          * i.e., out[j * d + row] for the j-th key
+          *
+          * @param signs optional, receives the corresponding signs
+          */
+         forceinline void indices(const Key* keys, const size_t& cnt, std::array<size_t, Batch * d>& out,
+                                  std::array<bool, Batch * d>* signs = nullptr) const {
+            alignas(32) std::array<HASH_32, Batch * d> hashes;
+            for (size_t j = 0; j < cnt; j++) {
+               for (size_t row = 0; row < d; row++) {
+                  const auto hash = rows[row](keys[j]);
+                  hashes[j * d + row] = reduction_bits(hash);
+                  if (signs != nullptr)
+                     (*signs)[j * d + row] = hash & 0x1;
+               }
+            }
+
+            const size_t i = dispatch::level() >= dispatch::Level::AVX2 ? reduce_avx2(hashes, cnt * d, out) : 0;
+            for (size_t j = i; j < cnt * d; j++)
+               out[j] = (j % d) * width + ((static_cast<HASH_64>(hashes[j]) * width) >> 32);
+         }
+
+         const size_t width;
+
+        private:
+         const std::array<Hashfn, d> rows;
+
+         /**
+          * fastrange on 8 hashes at once. mul_epu32 only multiplies even 32-bit lanes
+          * @return amount of reduced hashes, i.e., n rounded down to a multiple of 8
+          */
+         target_avx2 size_t reduce_avx2(const std::array<HASH_32, Batch * d>& hashes, const size_t& n,
+                                        std::array<size_t, Batch * d>& out) const {
+            const __m256i w = _mm256_set1_epi32(static_cast<HASH_32>(width));
+            alignas(32) std::array<HASH_32, 8> reduced;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+               const __m256i h = _mm256_load_si256(reinterpret_cast<const __m256i*>(&hashes[i]));
+               const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(h, w), 32);
+               const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(h, 32), w);
+               _mm256_store_si256(reinterpret_cast<__m256i*>(reduced.data()), _mm256_blend_epi32(even, odd, 0b10101010));
+
+               for (size_t l = 0; l < 8; l++)
+                  out[i + l] = ((i + l) % d) * width + reduced[l];
+            }
+            return i;
+         }
+
+         template<size_t... row>
+         static std::array<Hashfn, d> make_rows(const HASH_64& seed, std::index_sequence<row...>) {
+            const MurmurFinalizer<HASH_64> mix;
+            return {Hashfn(mix(seed + row))...};
+         }
+
+         /**
+          * @return 32 hash bits used for reduction. Signs are taken from the other end
+          */
+         template<class H>
+         static forceinline HASH_32 reduction_bits(const H& hash) {
+            if constexpr (sizeof(H) >= sizeof(HASH_64))
+               return static_cast<HASH_64>(hash) >> 32;
+            else
+               return static_cast<HASH_32>(hash);
+         }
+      };
+   } // namespace _
+
+   /**
+    * Count-min sketch (Cormode and Muthukrishnan: "An improved data stream summary: the
+    * count-min sketch and its applications", 2005). Estimates never underestimate the
+    * true frequency of a key. With width = ceil(e / epsilon) and d = ceil(ln(1 / delta)),
+    * estimates exceed the true frequency by more than epsilon * N with probability at
+    * most delta, where N is the total count inserted.
+    *
+    * @tparam Key key type
+    * @tparam Hashfn row hash function, must be constructible from a 64-bit seed
+    * @tparam d number of rows
+    * @tparam Counter counter type
+    * @tparam conservative whether to use conservative update (Estan and Varghese, 2002),
+    *    i.e., only increment counters up to the new minimum. This considerably reduces
+    *    overestimation but prevents merging and negative counts
+    */
+   template<class Key, class Hashfn = TabulationHash<Key>, const size_t d = 4, class Counter = std::uint32_t,
+            const bool conservative = false>
+   struct CountMin {
+      /**
+       * @param width counters per row
+       * @param seed used to derive the d row hash functions
+       */
+      explicit CountMin(const size_t& width, const HASH_64& seed = 0x238EF8E3LU)
+         : rows(width, seed), counters(d * width, 0) {}
+
+      static std::string name() {
+         return std::string(conservative ? "conservative_" : "") + "count_min" + std::to_string(d) + "_" +
+            Hashfn::name();
+      }
+
+      forceinline void update(const Key& key, const Counter& count = 1) {
+         std::array<size_t, d> idx;
+         for (size_t row = 0; row < d; row++)
+            idx[row] = rows.index(key, row);
+         apply(idx.data(), count);
+      }
+
+      /**
+       * Counts each of the n keys once. All d counters of a small batch of keys
+       * are computed and prefetched before any of them is incremented
+       */
+      void update(const Key* keys, const size_t& n) {
+         std::array<size_t, Batch * d> idx;
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            rows.indices(keys + i, cnt, idx);
+            for (size_t j = 0; j < cnt * d; j++)
+               prefetchit(&counters[idx[j]], 1, 3);
+            for (size_t j = 0; j < cnt; j++)
+               apply(&idx[j * d], 1);
+         }
+      }
+
+      /**
+       * @return estimated frequency of key, never less than the true frequency
+       */
+      forceinline Counter estimate(const Key& key) const {
+         Counter res = std::numeric_limits<Counter>::max();
+         for (size_t row = 0; row < d; row++)
+            res = std::min(res, counters[rows.index(key, row)]);
+         return res;
+      }
+
+      /**
+       * Adds other's counts to this sketch. Both sketches must have been
+       * constructed with identical width and seed
+       */
+      void merge(const CountMin& other) {
+         static_assert(!conservative, "conservative update sketches can not be merged");
+         if (rows.width != other.rows.width)
+            throw std::runtime_error("can not merge sketches of different width");
+
+         for (size_t i = 0; i < counters.size(); i++)
+            counters[i] += other.counters[i];
+      }
+
+      void clear() {
+         std::fill(counters.begin(), counters.end(), 0);
+      }
+
+      size_t width() const {
+         return rows.width;
+      }
+
+      /**
+       * @return size of the counters in bytes
+       */
+      size_t byte_size() const {
+         return counters.size() * sizeof(Counter);
+      }
+
+     private:
+      using Rows = _::Rows<Key, Hashfn, d>;
+      static constexpr size_t Batch = Rows::Batch;
+
+      const Rows rows;
+      std::vector<Counter> counters;
+
+      forceinline void apply(const size_t* idx, const Counter& count) {
+         if constexpr (conservative) {
+            Counter min = std::numeric_limits<Counter>::max();
+            for (size_t row = 0; row < d; row++)
+               min = std::min(min, counters[idx[row]]);
+            for (size_t row = 0; row < d; row++)
+               counters[idx[row]] = std::max(counters[idx[row]], static_cast<Counter>(min + count));
+         } else {
+            for (size_t row = 0; row < d; row++)
+               counters[idx[row]] += count;
+         }
+      }
+   };
+
+   /**
+    * Count sketch (Charikar et al.: "Finding frequent items in data streams", 2002).
+    * Each row additionally derives a sign from the key's hash and the estimate is the
+    * median across rows. Unlike count-min, estimates are unbiased and may under- or
+    * overestimate the true frequency.
+    *
+    * @tparam Key key type
+    * @tparam Hashfn row hash function, must be constructible from a 64-bit seed
+    * @tparam d number of rows, preferably odd
+    * @tparam Counter signed counter type
+    */
+   template<class Key, class Hashfn = TabulationHash<Key>, const size_t d = 5, class Counter = std::int32_t>
+   struct CountSketch {
+      static_assert(std::is_signed_v<Counter>, "count sketch counters must be signed");
+
+      /**
+       * @param width counters per row
+       * @param seed used to derive the d row hash functions
+       */
+      explicit CountSketch(const size_t& width, const HASH_64& seed = 0x238EF8E3LU)
+         : rows(width, seed), counters(d * width, 0) {}
+
+      static std::string name() {
+         return "count_sketch" + std::to_string(d) + "_" + Hashfn::name();
+      }
+
+      forceinline void update(const Key& key, const Counter& count = 1) {
+         for (size_t row = 0; row < d; row++) {
+            bool sign;
+            const auto idx = rows.index(key, row, sign);
+            counters[idx] += sign ? count : -count;
+         }
+      }
+
+      /**
+       * Counts each of the n keys once. All d counters of a small batch of keys
+       * are computed and prefetched before any of them is updated
+       */
+      void update(const Key* keys, const size_t& n) {
+         std::array<size_t, Batch * d> idx;
+         std::array<bool, Batch * d> signs;
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            rows.indices(keys + i, cnt, idx, &signs);
+            for (size_t j = 0; j < cnt * d; j++)
+               prefetchit(&counters[idx[j]], 1, 3);
+            for (size_t j = 0; j < cnt * d; j++)
+               counters[idx[j]] += signs[j] ? 1 : -1;
+         }
+      }
+
+      /**
+       * @return median of the signed row estimates
+       */
+      Counter estimate(const Key& key) const {
+         std::array<Counter, d> estimates;
+         for (size_t row = 0; row < d; row++) {
+            bool sign;
+            const auto c = counters[rows.index(key, row, sign)];
+            estimates[row] = sign ? c : -c;
+         }
+
+         std::nth_element(estimates.begin(), estimates.begin() + d / 2, estimates.end());
+         if constexpr (d % 2 == 1)
+            return estimates[d / 2];
+
+         const auto upper = estimates[d / 2];
+         return (*std::max_element(estimates.begin(), estimates.begin() + d / 2) + upper) / 2;
+      }
+
+      /**
+       * Adds other's counts to this sketch. Both sketches must have been
+       * constructed with identical width and seed
+       */
+      void merge(const CountSketch& other) {
+         if (rows.width != other.rows.width)
+            throw std::runtime_error("can not merge sketches of different width");
+
+         for (size_t i = 0; i < counters.size(); i++)
+            counters[i] += other.counters[i];
+      }
+
+      void clear() {
+         std::fill(counters.begin(), counters.end(), 0);
+      }
+
+      size_t width() const {
+         return rows.width;
+      }
+
+      /**
+       * @return size of the counters in bytes
+       */
+      size_t byte_size() const {
+         return counters.size() * sizeof(Counter);
+      }
+
+     private:
+      using Rows = _::Rows<Key, Hashfn, d>;
+      static constexpr size_t Batch = Rows::Batch;
+
+      const Rows rows;
+      std::vector<Counter> counters;
+   };
+} // namespace hashing::sketch
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "../dispatch.hpp"
+#include "../types.hpp"
+
+// Order important
+#include "../convenience/builtins.hpp"
+
+namespace hashing::sketch {
+   /**
+    * HyperLogLog cardinality sketch based on HyperLogLog++ (Heule et al.: "HyperLogLog in
+    * Practice: Algorithmic Engineering of a State of The Art Cardinality Estimation
+    * Algorithm", EDBT 2013).
+    *
+    * Small sketches are stored sparsely as a list of (index, rank) pairs at precision 25,
+    * estimated via linear counting. Once the list would occupy more memory than the dense
+    * representation, it is converted into 2^p 6-bit registers, packed 4 per 3 bytes
+    * (big endian, i.e., the same layout as base64). Dense sketches are estimated using the
+    * improved estimator from Ertl: "New cardinality estimation algorithms for HyperLogLog
+    * sketches" (2017), which is unbiased across the whole range and therefore does not
+    * require the empirical bias correction tables of HyperLogLog++.
+    *
+    * If the cpu supports AVX2, merging and the register histogram operate on 32 registers
+    * (24 bytes) at a time, unpacking them with the base64 encoding trick from Muła and
+    * Lemire: "Faster Base64 Encoding and Decoding Using AVX2 Instructions" (2018).
+    *
+    * @tparam Key key type
+    * @tparam Hashfn hash function, must produce 64 bit hash values
+    * @tparam p precision, i.e., log2 of the number of dense registers, in [4, 18].
+    *    Standard error is roughly 1.04 / sqrt(2^p)
+    */
+   template<class Key, class Hashfn, const size_t p = 14>
+   struct HyperLogLog {
+      static_assert(p >= 4 && p <= 18, "hyperloglog precision must be in [4, 18]");
+
+      HyperLogLog() = default;
+
+      static std::string name() {
+         return "hyperloglog" + std::to_string(p) + "_" + Hashfn::name();
+      }
+
+      forceinline void insert(const Key& key) {
+         insert_hash(hashfn(key));
+      }
+
+      /**
+       * Inserts n keys. Keys are hashed in small batches and, in dense
+       * mode, their registers are prefetched before any of them is updated
+       */
+      void insert(const Key* keys, const size_t& n) {
+         std::array<HASH_64, Batch> hashes;
+
+         for (size_t i = 0; i < n; i += Batch) {
+            const size_t cnt = std::min(Batch, n - i);
+            for (size_t j = 0; j < cnt; j++)
+               hashes[j] = hashfn(keys[i + j]);
+
+            if (sparse_mode) {
+               for (size_t j = 0; j < cnt; j++)
+                  insert_hash(hashes[j]);
+               continue;
+            }
+
+            for (size_t j = 0; j < cnt; j++)
+               prefetchit(&registers[(hashes[j] >> (64 - p)) / 4 * 3], 1, 3);
+            for (size_t j = 0; j < cnt; j++)
+               update(hashes[j] >> (64 - p), rank(hashes[j], p));
+         }
+      }
+
+      /**
+       * Merges other into this sketch, i.e., afterwards this sketch
+       * estimates the cardinality of the union of both key sets
+       */
+      void merge(const HyperLogLog& other) {
+         if (other.sparse_mode) {
+            if (sparse_mode) {
+               sparse.insert(sparse.end(), other.sparse.begin(), other.sparse.end());
+               compact();
+            } else {
+               for (const auto& entry : other.sparse)
+                  update_sparse(entry);
+            }
+            return;
+         }
+
+         if (sparse_mode)
+            to_dense();
+
+         const size_t offset = dispatch::level() >= dispatch::Level::AVX2 ? merge_avx2(other) : 0;
+         for (size_t i = offset / 3 * 4; i < NumRegisters; i++)
+            update(i, other.get(i));
+      }
+
+      /**
+       * @return estimated number of distinct keys inserted so far
+       */
+      double cardinality() const {
+         if (sparse_mode) {
+            // linear counting at sparse precision
+            auto entries = sparse;
+            std::sort(entries.begin(), entries.end());
+            size_t distinct = 0;
+            for (size_t i = 0; i < entries.size(); i++)
+               distinct += i == 0 || (entries[i] >> 6) != (entries[i - 1] >> 6);
+
+            constexpr double m = static_cast<double>(0x1LLU << SparsePrecision);
+            return m * std::log(m / (m - static_cast<double>(distinct)));
+         }
+
+         // histogram of register values, registers are at most Q + 1
+         std::array<size_t, Q + 2> histogram{};
+         const size_t offset = dispatch::level() >= dispatch::Level::AVX2 ? histogram_avx2(histogram) : 0;
+         for (size_t i = offset / 3 * 4; i < NumRegisters; i++)
+            histogram[get(i)]++;
+
+         constexpr double m = static_cast<double>(NumRegisters);
+         double z = m * tau(1.0 - static_cast<double>(histogram[Q + 1]) / m);
+         for (size_t k = Q; k >= 1; k--)
+            z = 0.5 * (z + static_cast<double>(histogram[k]));
+         z += m * sigma(static_cast<double>(histogram[0]) / m);
+
+         return 0.5 / std::log(2.0) * m * m / z;
+      }
+
+      /**
+       * Removes all keys and reverts to the sparse representation
+       */
+      void clear() {
+         sparse.clear();
+         sparse_limit = SparseLimit / 2;
+         registers.clear();
+         registers.shrink_to_fit();
+         sparse_mode = true;
+      }
+
+      /**
+       * @return whether the sketch is currently stored sparsely
+       */
+      bool is_sparse() const {
+         return sparse_mode;
+      }
+
+      /**
+       * @return size of the sketch in bytes
+       */
+      size_t byte_size() const {
+         return sparse_mode ? sparse.capacity() * sizeof(std::uint32_t) : registers.size();
+      }
+
+     private:
+      static constexpr size_t NumRegisters = 0x1LLU << p;
+      /// dense register bytes, 4 registers per 3 bytes
+      static constexpr size_t DenseBytes = NumRegisters / 4 * 3;
+      /// bytes processed per simd chunk, i.e., 32 registers
+      static constexpr size_t ChunkBytes = 24;
+      /// the last simd chunk is read using a 32 byte load
+      static constexpr size_t Padding = 32 - ChunkBytes;
+      /// maximum number of hash bits that contribute to a dense register's rank
+      static constexpr size_t Q = 64 - p;
+
+      static constexpr size_t SparsePrecision = 25;
+      /// sparse entries occupying the same memory as the dense representation
+      static constexpr size_t SparseLimit = DenseBytes / sizeof(std::uint32_t);
+
+      /// amount of keys hashed ahead of time during batched inserts
+      static constexpr size_t Batch = 16;
+
+      Hashfn hashfn;
+
+      bool sparse_mode = true;
+      /// sparse entries (index << 6 | rank). Duplicates are removed lazily
+      std::vector<std::uint32_t> sparse;
+      size_t sparse_limit = SparseLimit / 2;
+
+      /// packed dense registers, padded to allow 32 byte loads of the last simd chunk
+      std::vector<std::uint8_t> registers;
+
+      /**
+       * @return rank (number of leading zeros + 1) of the hash bits following the index bits
+       */
+      static forceinline std::uint8_t rank(const HASH_64& hash, const size_t& precision) {
+         const HASH_64 w = hash << precision;
+         return w == 0 ? 64 - precision + 1 : __builtin_clzll(w) + 1;
+      }
+
+      forceinline void insert_hash(const HASH_64& hash) {
+         if (!sparse_mode) {
+            update(hash >> (64 - p), rank(hash, p));
+            return;
+         }
+
+         sparse.push_back(static_cast<std::uint32_t>(hash >> (64 - SparsePrecision)) << 6 |
+                          rank(hash, SparsePrecision));
+         if (unlikely(sparse.size() >= sparse_limit))
+            compact();
+      }
+
+      /**
+       * sorts and deduplicates the sparse entries, keeping the maximum
+       * rank per index. Switches to the dense representation if the
+       * sparse one is no longer smaller
+       */
+      void compact() {
+         std::sort(sparse.begin(), sparse.end());
+         size_t size = 0;
+         for (size_t i = 0; i < sparse.size(); i++) {
+            // entries are sorted by index first, rank second. Keep the last one per index
+            if (i + 1 < sparse.size() && (sparse[i] >> 6) == (sparse[i + 1] >> 6))
+               continue;
+            sparse[size++] = sparse[i];
+         }
+         sparse.resize(size);
+
+         if (sparse.size() > SparseLimit / 2)
+            to_dense();
+         else
+            sparse_limit = std::max(SparseLimit / 2, 2 * sparse.size());
+      }
+
+      void to_dense() {
+         registers.assign(DenseBytes + Padding, 0);
+         sparse_mode = false;
+
+         for (const auto& entry : sparse)
+            update_sparse(entry);
+
+         sparse.clear();
+         sparse.shrink_to_fit();
+      }
+
+      /**
+       * applies a sparse entry to the dense registers. The bits following the dense
+       * index inside the sparse index are the leading bits of the dense rank
+       */
+      forceinline void update_sparse(const std::uint32_t& entry) {
+         constexpr size_t ExtraBits = SparsePrecision - p;
+
+         const std::uint32_t index = entry >> 6;
+         const std::uint32_t extra = index & ((0x1LU << ExtraBits) - 1);
+         const std::uint8_t r = extra == 0 ? ExtraBits + (entry & 0x3F) : __builtin_clz(extra) - (32 - ExtraBits) + 1;
+         update(index >> ExtraBits, r);
+      }
+
+      forceinline std::uint8_t get(const size_t& i) const {
+         const auto* bytes = &registers[i / 4 * 3];
+         const std::uint32_t v = bytes[0] << 16 | bytes[1] << 8 | bytes[2];
+         return (v >> (18 - 6 * (i % 4))) & 0x3F;
+      }
+
+      forceinline void update(const size_t& i, const std::uint8_t& r) {
+         auto* bytes = &registers[i / 4 * 3];
+         std::uint32_t v = bytes[0] << 16 | bytes[1] << 8 | bytes[2];
+         const size_t shift = 18 - 6 * (i % 4);
+         if (((v >> shift) & 0x3F) >= r)
+            return;
+
+         v = (v & ~(0x3FLU << shift)) | (static_cast<std::uint32_t>(r) << shift);
+         bytes[0] = v >> 16;
+         bytes[1] = v >> 8;
+         bytes[2] = v;
+      }
+
+      /**
+       * merges all full simd chunks of other into this sketch
+       * @return amount of merged register bytes
+       */
+      target_avx2 size_t merge_avx2(const HyperLogLog& other) {
+         size_t offset = 0;
+         for (; offset + ChunkBytes <= DenseBytes; offset += ChunkBytes)
+            pack(&registers[offset],
+                 _mm256_max_epu8(unpack(&registers[offset]), unpack(&other.registers[offset])));
+         return offset;
+      }
+
+      /**
+       * adds the registers of all full simd chunks to histogram
+       * @return amount of processed register bytes
+       */
+      target_avx2 size_t histogram_avx2(std::array<size_t, Q + 2>& histogram) const {
+         alignas(32) std::array<std::uint8_t, 32> values;
+         size_t offset = 0;
+         for (; offset + ChunkBytes <= DenseBytes; offset += ChunkBytes) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(values.data()), unpack(&registers[offset]));
+            for (const auto& v : values)
+               histogram[v]++;
+         }
+         return offset;
+      }
+
+      /**
+       * unpacks 32 registers (24 bytes) into one register per byte
+       */
+      static forceinline_avx2 __m256i unpack(const std::uint8_t* bytes) {
+         // move the second 12 bytes into the upper lane
+         const __m256i in = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes)),
+                                                        _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0));
+         // per 3 input bytes b0 b1 b2, form the 16-bit words (b0 b1) and (b1 b2)
+         const __m256i words = _mm256_shuffle_epi8(
+            in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10,
+                                 9, 11, 10));
+         // shift each 6-bit register into its own byte
+         const __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(words, _mm256_set1_epi32(0x0FC0FC00)),
+                                               _mm256_set1_epi32(0x04000040));
+         const __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(words, _mm256_set1_epi32(0x003F03F0)),
+                                               _mm256_set1_epi32(0x01000010));
+         return _mm256_or_si256(ac, bd);
+      }
+
+      /**
+       * inverse of unpack, writes exactly 24 bytes
+       */
+      static forceinline_avx2 void pack(std::uint8_t* bytes, const __m256i& values) {
+         // a * 64 + b and c * 64 + d per 16-bit word, then combine into 24-bit values per 32-bit word
+         const __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)),
+                                                  _mm256_set1_epi32(0x00011000));
+         // big endian byte order, first 12 bytes of each lane
+         const __m256i shuffled = _mm256_shuffle_epi8(
+            merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                     14, 13, 12, -1, -1, -1, -1));
+         const __m256i out = _mm256_permutevar8x32_epi32(shuffled, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+         _mm256_maskstore_epi32(reinterpret_cast<int*>(bytes), _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0), out);
+      }
+
+      /**
+       * sigma and tau as defined by Ertl
+       */
+      static double sigma(double x) {
+         if (x == 1.0)
+            return std::numeric_limits<double>::infinity();
+
+         double y = 1.0, z = x, prev;
+         do {
+            x *= x;
+            prev = z;
+            z += x * y;
+            y += y;
+         } while (z != prev);
+         return z;
+      }
+
+      static double tau(double x) {
+         if (x == 0.0 || x == 1.0)
+            return 0.0;
+
+         double y = 1.0, z = 1.0 - x, prev;
+         do {
+            x = std::sqrt(x);
+            prev = z;
+            y *= 0.5;
+            z -= (1.0 - x) * (1.0 - x) * y;
+         } while (z != prev);
+         return z / 3.0;
+      }
+   };
+} // namespace hashing::sketch
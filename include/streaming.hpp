@@ -0,0 +1,49 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "aqua.hpp"
+#include "meow.hpp"
+#include "xxh.hpp"
+
+// Order important
+#include "convenience/builtins.hpp"
+
+namespace hashing::streaming {
+   /**
+    * Common interface of incremental hash functions, e.g., XXHash3Stream, MeowHashStream
+    * and AquaHashStream: input is appended in arbitrarily sized chunks via update() and
+    * digest() returns the hash of all input appended since construction or the last reset().
+    * Chunk boundaries never influence the digest
+    */
+   template<class H>
+   concept Hasher = std::default_initializable<H> &&
+      requires(H h, const H& ch, const void* data, std::size_t len, std::string_view view) {
+         typename H::Digest;
+         { H::name() } -> std::convertible_to<std::string>;
+         h.reset();
+         h.update(data, len);
+         h.update(view);
+         { ch.digest() } -> std::same_as<typename H::Digest>;
+      };
+
+   static_assert(Hasher<XXHash3Stream<HASH_64>> && Hasher<XXHash3Stream<HASH_128>>);
+   static_assert(Hasher<MeowHashStream<HASH_64>> && Hasher<MeowHashStream<HASH_128>>);
+   static_assert(Hasher<AquaHashStream<HASH_64>> && Hasher<AquaHashStream<HASH_128>>);
+
+   /**
+    * Hashes a record that is scattered across multiple buffers, e.g., a record
+    * spanning a buffer boundary, without copying it into a contiguous buffer first
+    *
+    * @param chunks range of std::string_view convertible chunks, hashed in order
+    */
+   template<Hasher H, class Chunks>
+   typename H::Digest hash_chunks(const Chunks& chunks, H hasher = H()) {
+      for (const auto& chunk : chunks)
+         hasher.update(std::string_view(chunk));
+      return hasher.digest();
+   }
+} // namespace hashing::streaming
@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <random>
 #include <string>
 
@@ -19,22 +22,24 @@ namespace hashing {
       }
 
       /**
-       * Initializes a tabulation hash tables with random data, depending on seed
-       * @tparam T hash output type, e.g., HASH_64
-       * @param table, must have 255 rows
-       * @param seed defaults to 1
+       * Initializes the tabulation tables with random data from a random device
        */
-      TabulationHash() {
-         std::random_device dev;
-         std::default_random_engine rng(dev());
+      TabulationHash() : TabulationHash(std::random_device()()) {}
+
+      /**
+       * Deterministically initializes the tabulation tables with random data.
+       * Differently seeded instances behave like independent hash functions,
+       * e.g., to obtain the rows of a count-min sketch
+       *
+       * @param table_seed seed for the random number generator filling the tables
+       */
+      explicit TabulationHash(const std::uint64_t& table_seed) {
+         std::mt19937_64 rng(table_seed);
          std::uniform_int_distribution<T> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
 
          const auto gen_column = [&](std::array<T, ROWS>& column) {
-            for (auto& r : column) {
-               r = 0;
-               for (size_t i = 0; i < sizeof(T); i++)
-                  r |= dist(rng) << (8 * i);
-            }
+            for (auto& r : column)
+               r = dist(rng);
          };
 
          for (size_t c = 0; c < COLUMNS; c++)
@@ -78,10 +78,18 @@ XXH32        6.8 GB/s            6.0 GB/s
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__x86_64__)
+   #include <immintrin.h>
+#endif
 
 #include "convenience/builtins.hpp"
+#include "dispatch.hpp"
 #include "types.hpp"
 
 namespace hashing {
@@ -2851,6 +2859,20 @@ namespace hashing {
          #define XXH_VSX 5
       #endif
 
+      /*
+ * On x86-64, the SSE2, AVX2 and AVX512 implementations are all compiled for their
+ * respective target and long inputs select among them at runtime by
+ * hashing::dispatch::level(), like xxh_x86dispatch.c does with its own cpu detection.
+ * XXH_VECTOR then only determines the implementation used by the streaming API.
+ */
+      #if !defined(XXH_X86DISPATCH) && !defined(XXH_VECTOR) && defined(__x86_64__) && defined(__GNUC__)
+         #define XXH_X86DISPATCH
+         #define XXH_DISPATCH_AVX2 1
+         #define XXH_DISPATCH_AVX512 1
+         #define XXH_TARGET_AVX2 __attribute__((__target__("avx2")))
+         #define XXH_TARGET_AVX512 __attribute__((__target__("avx512f")))
+      #endif
+
       #ifndef XXH_VECTOR /* can be defined on command line */
          #if defined(__AVX512F__)
             #define XXH_VECTOR XXH_AVX512
@@ -3666,6 +3688,18 @@ namespace hashing {
             #define XXH_TARGET_AVX512 /* disable attribute target */
          #endif
 
+         /*
+          * GCC 12 implements _mm512_undefined_epi32() as a self-initialized
+          * local, which -Wmaybe-uninitialized reports once the shuffles and
+          * multiplies below are inlined into XXH3_hashLong_*. The value is
+          * never read, so silence the false positive for these kernels only.
+          */
+         #if defined(__GNUC__) && !defined(__clang__)
+            #pragma GCC diagnostic push
+            #pragma GCC diagnostic ignored "-Wuninitialized"
+            #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+         #endif
+
       XXH_FORCE_INLINE XXH_TARGET_AVX512 void XXH3_accumulate_512_avx512(void* XXH_RESTRICT acc,
                                                                          const void* XXH_RESTRICT input,
                                                                          const void* XXH_RESTRICT secret) {
@@ -3763,6 +3797,10 @@ namespace hashing {
          }
       }
 
+         #if defined(__GNUC__) && !defined(__clang__)
+            #pragma GCC diagnostic pop
+         #endif
+
       #endif
 
       #if (XXH_VECTOR == XXH_AVX2) || (defined(XXH_DISPATCH_AVX2) && XXH_DISPATCH_AVX2 != 0)
@@ -4385,6 +4423,7 @@ namespace hashing {
          return XXH3_mergeAccs(acc, (const xxh_u8*) secret + XXH_SECRET_MERGEACCS_START, (xxh_u64) len * XXH_PRIME64_1);
       }
 
+      #ifndef XXH_X86DISPATCH
       /*
  * It's important for performance that XXH3_hashLong is not inlined.
  */
@@ -4411,6 +4450,7 @@ namespace hashing {
          return XXH3_hashLong_64b_internal(input, len, XXH3_kSecret, sizeof(XXH3_kSecret), XXH3_accumulate_512,
                                            XXH3_scrambleAcc);
       }
+      #endif
 
       /*
  * XXH3_hashLong_64b_withSeed():
@@ -4437,6 +4477,7 @@ namespace hashing {
          }
       }
 
+      #ifndef XXH_X86DISPATCH
       /*
  * It's important for performance that XXH3_hashLong is not inlined.
  */
@@ -4447,6 +4488,70 @@ namespace hashing {
          return XXH3_hashLong_64b_withSeed_internal(input, len, seed, XXH3_accumulate_512, XXH3_scrambleAcc,
                                                     XXH3_initCustomSecret);
       }
+      #else
+      /*
+ * XXH3_hashLong_64b_* compiled for each x86 target. The accumulate and scramble
+ * functions are only inlined into callers compiled for (at least) their target.
+ */
+         #define XXH3_HASHLONG_64B_TARGET(suffix, target)                                                             \
+            XXH_NO_INLINE target XXH64_hash_t XXH3_hashLong_64b_default_##suffix(const void* XXH_RESTRICT input,     \
+                                                                                 size_t len) {                       \
+               return XXH3_hashLong_64b_internal(input, len, XXH3_kSecret, sizeof(XXH3_kSecret),                     \
+                                                 XXH3_accumulate_512_##suffix, XXH3_scrambleAcc_##suffix);           \
+            }                                                                                                        \
+            XXH_NO_INLINE target XXH64_hash_t XXH3_hashLong_64b_withSecret_##suffix(                                 \
+               const void* XXH_RESTRICT input, size_t len, const xxh_u8* XXH_RESTRICT secret, size_t secretLen) {    \
+               return XXH3_hashLong_64b_internal(input, len, secret, secretLen, XXH3_accumulate_512_##suffix,        \
+                                                 XXH3_scrambleAcc_##suffix);                                         \
+            }                                                                                                        \
+            XXH_NO_INLINE target XXH64_hash_t XXH3_hashLong_64b_withSeed_##suffix(const void* input, size_t len,     \
+                                                                                  XXH64_hash_t seed) {               \
+               return XXH3_hashLong_64b_withSeed_internal(input, len, seed, XXH3_accumulate_512_##suffix,            \
+                                                          XXH3_scrambleAcc_##suffix, XXH3_initCustomSecret_##suffix); \
+            }
+
+      XXH3_HASHLONG_64B_TARGET(sse2, XXH_TARGET_SSE2)
+      XXH3_HASHLONG_64B_TARGET(avx2, XXH_TARGET_AVX2)
+      XXH3_HASHLONG_64B_TARGET(avx512, XXH_TARGET_AVX512)
+         #undef XXH3_HASHLONG_64B_TARGET
+
+      /*
+ * Calls fn compiled for the widest vector extension dispatch::level() permits. SSE2 is
+ * part of x86-64, i.e., is also used at the SCALAR and SSE42_AES levels.
+ */
+         #define XXH3_DISPATCH(fn, ...)                  \
+            switch (dispatch::level()) {                 \
+               case dispatch::Level::AVX512:             \
+                  return fn##_avx512(__VA_ARGS__);       \
+               case dispatch::Level::AVX2:               \
+                  return fn##_avx2(__VA_ARGS__);         \
+               default:                                  \
+                  return fn##_sse2(__VA_ARGS__);         \
+            }
+
+      XXH_NO_INLINE XXH64_hash_t XXH3_hashLong_64b_withSecret(const void* XXH_RESTRICT input, size_t len,
+                                                              XXH64_hash_t seed64, const xxh_u8* XXH_RESTRICT secret,
+                                                              size_t secretLen) {
+         (void) seed64;
+         XXH3_DISPATCH(XXH3_hashLong_64b_withSecret, input, len, secret, secretLen)
+      }
+
+      XXH_NO_INLINE XXH64_hash_t XXH3_hashLong_64b_default(const void* XXH_RESTRICT input, size_t len,
+                                                           XXH64_hash_t seed64, const xxh_u8* XXH_RESTRICT secret,
+                                                           size_t secretLen) {
+         (void) seed64;
+         (void) secret;
+         (void) secretLen;
+         XXH3_DISPATCH(XXH3_hashLong_64b_default, input, len)
+      }
+
+      XXH_NO_INLINE XXH64_hash_t XXH3_hashLong_64b_withSeed(const void* input, size_t len, XXH64_hash_t seed,
+                                                            const xxh_u8* secret, size_t secretLen) {
+         (void) secret;
+         (void) secretLen;
+         XXH3_DISPATCH(XXH3_hashLong_64b_withSeed, input, len, seed)
+      }
+      #endif
 
       typedef XXH64_hash_t (*XXH3_hashLong64_f)(const void* XXH_RESTRICT, size_t, XXH64_hash_t,
                                                 const xxh_u8* XXH_RESTRICT, size_t);
@@ -5093,6 +5198,7 @@ namespace hashing {
          }
       }
 
+      #ifndef XXH_X86DISPATCH
       /*
  * It's important for performance that XXH3_hashLong is not inlined.
  */
@@ -5116,6 +5222,7 @@ namespace hashing {
          return XXH3_hashLong_128b_internal(input, len, (const xxh_u8*) secret, secretLen, XXH3_accumulate_512,
                                             XXH3_scrambleAcc);
       }
+      #endif
 
       XXH_FORCE_INLINE XXH128_hash_t XXH3_hashLong_128b_withSeed_internal(const void* XXH_RESTRICT input, size_t len,
                                                                           XXH64_hash_t seed64,
@@ -5132,6 +5239,7 @@ namespace hashing {
          }
       }
 
+      #ifndef XXH_X86DISPATCH
       /*
  * It's important for performance that XXH3_hashLong is not inlined.
  */
@@ -5142,6 +5250,57 @@ namespace hashing {
          return XXH3_hashLong_128b_withSeed_internal(input, len, seed64, XXH3_accumulate_512, XXH3_scrambleAcc,
                                                      XXH3_initCustomSecret);
       }
+      #else
+      /*
+ * XXH3_hashLong_128b_* compiled for each x86 target, see XXH3_hashLong_64b_*
+ */
+         #define XXH3_HASHLONG_128B_TARGET(suffix, target)                                                             \
+            XXH_NO_INLINE target XXH128_hash_t XXH3_hashLong_128b_default_##suffix(const void* XXH_RESTRICT input,    \
+                                                                                   size_t len) {                      \
+               return XXH3_hashLong_128b_internal(input, len, XXH3_kSecret, sizeof(XXH3_kSecret),                     \
+                                                  XXH3_accumulate_512_##suffix, XXH3_scrambleAcc_##suffix);           \
+            }                                                                                                         \
+            XXH_NO_INLINE target XXH128_hash_t XXH3_hashLong_128b_withSecret_##suffix(                                \
+               const void* XXH_RESTRICT input, size_t len, const void* XXH_RESTRICT secret, size_t secretLen) {       \
+               return XXH3_hashLong_128b_internal(input, len, (const xxh_u8*) secret, secretLen,                      \
+                                                  XXH3_accumulate_512_##suffix, XXH3_scrambleAcc_##suffix);           \
+            }                                                                                                         \
+            XXH_NO_INLINE target XXH128_hash_t XXH3_hashLong_128b_withSeed_##suffix(const void* input, size_t len,    \
+                                                                                    XXH64_hash_t seed64) {            \
+               return XXH3_hashLong_128b_withSeed_internal(input, len, seed64, XXH3_accumulate_512_##suffix,          \
+                                                           XXH3_scrambleAcc_##suffix,                                 \
+                                                           XXH3_initCustomSecret_##suffix);                           \
+            }
+
+      XXH3_HASHLONG_128B_TARGET(sse2, XXH_TARGET_SSE2)
+      XXH3_HASHLONG_128B_TARGET(avx2, XXH_TARGET_AVX2)
+      XXH3_HASHLONG_128B_TARGET(avx512, XXH_TARGET_AVX512)
+         #undef XXH3_HASHLONG_128B_TARGET
+
+      XXH_NO_INLINE XXH128_hash_t XXH3_hashLong_128b_default(const void* XXH_RESTRICT input, size_t len,
+                                                             XXH64_hash_t seed64, const void* XXH_RESTRICT secret,
+                                                             size_t secretLen) {
+         (void) seed64;
+         (void) secret;
+         (void) secretLen;
+         XXH3_DISPATCH(XXH3_hashLong_128b_default, input, len)
+      }
+
+      XXH_NO_INLINE XXH128_hash_t XXH3_hashLong_128b_withSecret(const void* XXH_RESTRICT input, size_t len,
+                                                                XXH64_hash_t seed64, const void* XXH_RESTRICT secret,
+                                                                size_t secretLen) {
+         (void) seed64;
+         XXH3_DISPATCH(XXH3_hashLong_128b_withSecret, input, len, secret, secretLen)
+      }
+
+      XXH_NO_INLINE XXH128_hash_t XXH3_hashLong_128b_withSeed(const void* input, size_t len, XXH64_hash_t seed64,
+                                                              const void* XXH_RESTRICT secret, size_t secretLen) {
+         (void) secret;
+         (void) secretLen;
+         XXH3_DISPATCH(XXH3_hashLong_128b_withSeed, input, len, seed64)
+      }
+         #undef XXH3_DISPATCH
+      #endif
 
       typedef XXH128_hash_t (*XXH3_hashLong128_f)(const void* XXH_RESTRICT, size_t, XXH64_hash_t,
                                                   const void* XXH_RESTRICT, size_t);
@@ -5320,26 +5479,53 @@ namespace hashing {
 #endif /* XXH_IMPLEMENTATION */
    } // namespace _XXHash
 
-   template<class T, const std::uint32_t seed = 0>
+   /**
+    * @tparam default_seed seed used by default constructed instances. name() reports this seed
+    */
+   template<class T, const std::uint32_t default_seed = 0>
    struct XXHash32 {
       static std::string name() {
-         return "xxh32_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(seed);
+         return "xxh32_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(default_seed);
       }
 
+      /// hashes are returned as size_t but only span 32 bits
+      static constexpr size_t output_bits = 32;
+
+      explicit XXHash32(const std::uint32_t& seed = default_seed) : seed(seed) {}
+
       forceinline size_t operator()(const T& value, const size_t len = sizeof(T)) const {
          return _XXHash::XXH32(&value, len, seed);
       };
+
+      forceinline size_t operator()(const std::string_view& key) const {
+         return _XXHash::XXH32(key.data(), key.size(), seed);
+      }
+
+     private:
+      std::uint32_t seed;
    };
 
-   template<class T, const std::uint32_t seed = 0>
+   /**
+    * @tparam default_seed seed used by default constructed instances. name() reports this seed
+    */
+   template<class T, const std::uint64_t default_seed = 0>
    struct XXHash64 {
       static std::string name() {
-         return "xxh64_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(seed);
+         return "xxh64_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(default_seed);
       }
 
+      explicit XXHash64(const std::uint64_t& seed = default_seed) : seed(seed) {}
+
       forceinline size_t operator()(const T& value, const size_t len = sizeof(T)) const {
          return _XXHash::XXH64(&value, len, seed);
       }
+
+      forceinline size_t operator()(const std::string_view& key) const {
+         return _XXHash::XXH64(key.data(), key.size(), seed);
+      }
+
+     private:
+      std::uint64_t seed;
    };
 
    template<class T>
@@ -5348,19 +5534,61 @@ namespace hashing {
          return "xxh3_" + std::to_string(sizeof(T) * 8);
       }
 
+      /// sorting by length only pays for strings up to 16 bytes, see columnar::ColumnHasher
+      static constexpr size_t columnar_sort_length = 16;
+
       forceinline HASH_64 operator()(const T& value, const size_t len = sizeof(T)) const {
          return _XXHash::XXH3_64bits(&value, len);
       }
+
+      forceinline HASH_64 operator()(const std::string_view& key) const {
+         return _XXHash::XXH3_64bits(key.data(), key.size());
+      }
    };
 
-   template<class T, const std::uint64_t seed>
+   namespace _ {
+      /**
+       * Seed and the custom secret XXH3 derives from it. Inputs longer than XXH3_MIDSIZE_MAX
+       * are hashed with the secret, which otherwise would be regenerated on every call
+       */
+      struct XXH3Seed {
+         explicit XXH3Seed(const HASH_64& seed) : seed(seed) {
+            _XXHash::XXH3_initCustomSecret(secret.data(), seed);
+         }
+
+         HASH_64 seed;
+         alignas(64) std::array<std::uint8_t, XXH_SECRET_DEFAULT_SIZE> secret;
+      };
+   } // namespace _
+
+   /**
+    * XXH3 with a seed, equivalent to XXH3_64bits_withSeed
+    *
+    * @tparam default_seed seed used by default constructed instances. name() reports this seed
+    */
+   template<class T, const std::uint64_t default_seed = 0>
    struct XXHash3Seeded {
       static std::string name() {
-         return "xxh3_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(seed);
+         return "xxh3_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(default_seed);
       }
 
+      explicit XXHash3Seeded(const HASH_64& seed = default_seed) : state(seed) {}
+
       forceinline HASH_64 operator()(const T& value, const size_t len = sizeof(T)) const {
-         return _XXHash::XXH3_64bits_withSeed(&value, len, seed);
+         return hash(&value, len);
+      }
+
+      forceinline HASH_64 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
+
+     private:
+      _::XXH3Seed state;
+
+      forceinline HASH_64 hash(const void* data, const size_t& len) const {
+         if (len <= XXH3_MIDSIZE_MAX)
+            return _XXHash::XXH3_64bits_withSeed(data, len, state.seed);
+         return _XXHash::XXH3_64bits_withSecret(data, len, state.secret.data(), state.secret.size());
       }
    };
 
@@ -5374,18 +5602,100 @@ namespace hashing {
          const auto val = _XXHash::XXH3_128bits(&value, len);
          return to_hash128(val.high64, val.low64);
       }
+
+      forceinline HASH_128 operator()(const std::string_view& key) const {
+         const auto val = _XXHash::XXH3_128bits(key.data(), key.size());
+         return to_hash128(val.high64, val.low64);
+      }
    };
 
-   template<class T, const HASH_64 seed>
+   /**
+    * XXH3 128-bit with a seed, equivalent to XXH3_128bits_withSeed
+    *
+    * @tparam default_seed seed used by default constructed instances. name() reports this seed
+    */
+   template<class T, const HASH_64 default_seed = 0>
    struct XXHash3_128Seeded {
       static std::string name() {
-         return "xxh128_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(seed);
+         return "xxh128_" + std::to_string(sizeof(T) * 8) + "_" + std::to_string(default_seed);
       }
 
+      explicit XXHash3_128Seeded(const HASH_64& seed = default_seed) : state(seed) {}
+
       forceinline HASH_128 operator()(const T& value, const size_t len = sizeof(T)) const {
-         const auto val = _XXHash::XXH3_128bits_withSeed(&value, len, seed);
+         return hash(&value, len);
+      }
+
+      forceinline HASH_128 operator()(const std::string_view& key) const {
+         return hash(key.data(), key.size());
+      }
+
+     private:
+      _::XXH3Seed state;
+
+      forceinline HASH_128 hash(const void* data, const size_t& len) const {
+         const auto val = len <= XXH3_MIDSIZE_MAX ?
+            _XXHash::XXH3_128bits_withSeed(data, len, state.seed) :
+            _XXHash::XXH3_128bits_withSecret(data, len, state.secret.data(), state.secret.size());
          return to_hash128(val.high64, val.low64);
       }
    };
+
+   /**
+    * Incremental XXH3, i.e., input may be appended in arbitrarily sized chunks. The
+    * digest is identical to XXHash3 (HASH_64) or XXHash3_128 (HASH_128) of the
+    * concatenated input, seeded like XXH3_*bits_withSeed if seed != 0
+    *
+    * @tparam Result digest type, either HASH_64 or HASH_128
+    */
+   template<class Result = HASH_64>
+   struct XXHash3Stream {
+      static_assert(std::is_same_v<Result, HASH_64> || std::is_same_v<Result, HASH_128>,
+                    "xxh3 digests are either 64 or 128 bits wide");
+
+      using Digest = Result;
+
+      static std::string name() {
+         return "xxh3_stream_" + std::to_string(sizeof(Result) * 8);
+      }
+
+      explicit XXHash3Stream(const HASH_64& seed = 0) : seed(seed) {
+         XXH3_INITSTATE(&state);
+         reset();
+      }
+
+      /**
+       * discards all previously appended input
+       */
+      void reset() {
+         // 64 and 128 bit variants share their state, only digests differ
+         _XXHash::XXH3_64bits_reset_withSeed(&state, seed);
+      }
+
+      forceinline void update(const void* data, const size_t& len) {
+         _XXHash::XXH3_64bits_update(&state, data, len);
+      }
+
+      forceinline void update(const std::string_view& data) {
+         update(data.data(), data.size());
+      }
+
+      /**
+       * @return hash of all input appended since the last reset. Does not modify the state,
+       *    i.e., more input may be appended afterwards
+       */
+      Digest digest() const {
+         if constexpr (std::is_same_v<Result, HASH_64>) {
+            return _XXHash::XXH3_64bits_digest(&state);
+         } else {
+            const auto val = _XXHash::XXH3_128bits_digest(&state);
+            return to_hash128(val.high64, val.low64);
+         }
+      }
+
+     private:
+      const HASH_64 seed;
+      _XXHash::XXH3_state_t state;
+   };
 } // namespace hashing
 #undef XXH_INLINE_ALL
@@ -1,15 +1,30 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <hashing.hpp>
 #include <benchmark/benchmark.h>
 
 #include "./datasets.hpp"
+#include "./memory.hpp"
+#include "./parallel.hpp"
+#include "./perf.hpp"
+#include "./tables.hpp"
+#include "./threads.hpp"
 
 const std::vector<std::int64_t> throughput_ds_sizes{200'000'000};
 const std::vector<std::int64_t> throughput_ds{static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::UNIFORM)};
+const std::vector<std::int64_t> working_set_ds_sizes{10'000'000};
+// table sizes that fit into L1, L2 and the LLC of typical server cpus, and one that only fits into DRAM
+const std::vector<std::int64_t> working_set_bytes{16 * 1024, 512 * 1024, 16 * 1024 * 1024, 1024 * 1024 * 1024};
 const std::vector<std::int64_t> scattering_ds_sizes{10'000'000};
 const std::vector<std::int64_t> scattering_ds{static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::SEQUENTIAL),
                                               static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::GAPPED_10),
@@ -19,27 +34,49 @@ const std::vector<std::int64_t> scattering_ds{static_cast<std::underlying_type_t
                                               static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::FB),
                                               static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::OSM),
                                               static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::WIKI)};
+const std::vector<std::int64_t> filter_ds_sizes{10'000'000};
+const std::vector<std::int64_t> filter_ds{static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::SEQUENTIAL),
+                                          static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::UNIFORM),
+                                          static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::FB),
+                                          static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::OSM)};
+const std::vector<std::int64_t> table_ds_sizes{2'000'000};
+const std::vector<std::int64_t> table_ds{static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::SEQUENTIAL),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::GAPPED_10),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::UNIFORM),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::NORMAL),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::BOOKS),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::FB),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::OSM),
+                                         static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::WIKI)};
+// in percent
+const std::vector<std::int64_t> table_load_factors{50, 75, 90, 95};
+const std::vector<std::int64_t> string_ds_sizes{10'000'000};
+const std::vector<std::int64_t> string_ds{static_cast<std::underlying_type_t<dataset::StringID>>(dataset::StringID::URLS),
+                                          static_cast<std::underlying_type_t<dataset::StringID>>(dataset::StringID::EMAILS),
+                                          static_cast<std::underlying_type_t<dataset::StringID>>(dataset::StringID::TOKENS)};
+const std::vector<std::int64_t> sketch_ds_sizes{10'000, 10'000'000};
+const std::vector<std::int64_t> sketch_ds{static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::UNIFORM),
+                                          static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::FB),
+                                          static_cast<std::underlying_type_t<dataset::ID>>(dataset::ID::WIKI)};
 
 template<class Hashfn, class Reductionfn, class Data>
 auto __BM_throughput = [](benchmark::State& state) {
    const auto ds_size = state.range(0);
    const auto ds_id = static_cast<dataset::ID>(state.range(1));
 
-   // load dataset
-   auto dataset = dataset::load_cached(ds_id, ds_size);
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
    if (dataset.empty())
       throw std::runtime_error("benchmark dataset empty");
 
-   // shuffle dataset
-   std::random_device rd_dev;
-   std::default_random_engine rng(rd_dev());
-   std::shuffle(dataset.begin(), dataset.end(), rng);
-
    const Hashfn hashfn;
    const Reductionfn reductionfn(dataset.size());
 
    // alternatively, we could hash once per outer loop iteration. However, the overhead due to
    // gbench is too high for meaningful measurements of the fastest hashfns.
+   perf::Counters counters;
+   counters.start();
    for (auto _ : state) {
       for (const auto& key : dataset) {
          const auto hash = hashfn(key);
@@ -48,27 +85,261 @@ auto __BM_throughput = [](benchmark::State& state) {
          __sync_synchronize();
       }
    }
+   counters.stop();
 
    state.counters["dataset_size"] = dataset.size();
    state.SetLabel(Hashfn::name() + ":" + Reductionfn::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
    state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
    state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
 };
 
 template<class Hashfn, class Reductionfn, class Data>
-auto __BM_scattering = [](benchmark::State& state) {
+auto __BM_throughput_nofence = [](benchmark::State& state) {
    const auto ds_size = state.range(0);
    const auto ds_id = static_cast<dataset::ID>(state.range(1));
 
-   // load dataset
-   auto dataset = dataset::load_cached(ds_id, ds_size);
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
    if (dataset.empty())
       throw std::runtime_error("benchmark dataset empty");
 
-   // shuffle dataset
-   std::random_device rd_dev;
-   std::default_random_engine rng(rd_dev());
-   std::shuffle(dataset.begin(), dataset.end(), rng);
+   const Hashfn hashfn;
+   const Reductionfn reductionfn(dataset.size());
+
+   // hashes are independent, i.e., the cpu may overlap (and the compiler may vectorize)
+   // consecutive invocations. Accumulating the results keeps them alive without a fence
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      size_t acc = 0;
+      for (const auto& key : dataset) {
+         const auto hash = hashfn(key);
+         const auto index = reductionfn(hash);
+         acc ^= static_cast<size_t>(index);
+      }
+      benchmark::DoNotOptimize(acc);
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.SetLabel(Hashfn::name() + ":" + Reductionfn::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Hashfn, class Reductionfn, class Data>
+auto __BM_latency = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   const Hashfn hashfn;
+   const Reductionfn reductionfn(dataset.size());
+
+   // each key depends on the previous output, i.e., like chasing pointers, a hash can not
+   // start before its predecessor finished. Keys are still read sequentially, hence the
+   // measurement is dominated by the hashfn's (and reductionfn's) latency instead of memory
+   // latency. Mixing the output into the key changes the hashed values, not their cost
+   Data prev = 0;
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      for (const auto& key : dataset) {
+         const auto hash = hashfn(static_cast<Data>(key ^ prev));
+         const auto index = reductionfn(hash);
+         prev = static_cast<Data>(index);
+      }
+      benchmark::DoNotOptimize(prev);
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.SetLabel(Hashfn::name() + ":" + Reductionfn::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Data>
+auto __BM_scaling = [](benchmark::State& state, const std::string& hashfn_name, const std::string& reducer_name) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+   const auto num_threads = static_cast<size_t>(state.range(2));
+   const bool smt = state.range(3) != 0;
+
+   const auto cpus = threads::cpus(smt);
+   if (num_threads > cpus.size()) {
+      state.SkipWithError("not enough cpus available");
+      return;
+   }
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // type erased functions take Data keys, i.e., truncate like the templated benchmarks do implicitly
+   std::vector<Data> truncated;
+   const Data* keys;
+   if constexpr (std::is_same_v<Data, std::uint64_t>) {
+      keys = dataset.data();
+   } else {
+      truncated.assign(dataset.begin(), dataset.end());
+      keys = truncated.data();
+   }
+
+   // one indirect call per batch of keys
+   constexpr size_t batch_size = 1024;
+   const auto& hashfn = hashing::registry::Registry<Data>::defaults().get(hashfn_name);
+   const auto reducer = hashing::registry::make_reducer(reducer_name, dataset.size());
+
+   // one cache line per thread to prevent false sharing
+   struct alignas(64) Result {
+      size_t acc;
+   };
+   std::vector<Result> results(num_threads);
+
+   // each of n threads is pinned to its cpu and hashes a contiguous partition of the dataset
+   const auto run = [&](const size_t n) {
+      const size_t partition_size = (dataset.size() + n - 1) / n;
+      std::vector<std::thread> workers;
+      workers.reserve(n);
+      for (size_t t = 0; t < n; t++)
+         workers.emplace_back([&, t] {
+            threads::pin(cpus[t]);
+            const size_t begin = std::min(t * partition_size, dataset.size());
+            const size_t end = std::min(begin + partition_size, dataset.size());
+
+            std::vector<HASH_64> indices(batch_size);
+            size_t acc = 0;
+            for (size_t i = begin; i < end; i += batch_size) {
+               const size_t cnt = std::min(batch_size, end - i);
+               hashfn(keys + i, cnt, indices.data());
+               reducer(indices.data(), cnt, indices.data());
+               for (size_t j = 0; j < cnt; j++)
+                  acc ^= static_cast<size_t>(indices[j]);
+            }
+            results[t].acc = acc;
+         });
+      for (auto& worker : workers)
+         worker.join();
+      benchmark::DoNotOptimize(results.data());
+      benchmark::ClobberMemory();
+   };
+   const auto time = [&](const size_t n) {
+      const auto start = std::chrono::steady_clock::now();
+      run(n);
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   };
+
+   // single threaded baseline, i.e., the throughput each thread would ideally sustain. The
+   // fastest of a few passes is used since a single pass is prone to noise
+   double baseline_time = time(1);
+   for (size_t i = 1; i < 3; i++)
+      baseline_time = std::min(baseline_time, time(1));
+   const double baseline = static_cast<double>(dataset.size()) / baseline_time;
+
+   double elapsed = 0;
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state)
+      elapsed += time(num_threads);
+   counters.stop();
+
+   const double processed = static_cast<double>(dataset.size()) * static_cast<double>(state.iterations());
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["threads"] = num_threads;
+   state.counters["smt"] = smt;
+   state.counters["keys_per_second"] = processed / elapsed;
+   state.counters["efficiency"] = processed / elapsed / (static_cast<double>(num_threads) * baseline);
+   state.counters["batch_size"] = batch_size;
+   state.SetLabel(hashfn_name + ":" + reducer_name + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Data>
+auto __BM_working_set = [](benchmark::State& state, const std::string& hashfn_name,
+                                   const std::string& reducer_name) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+   const auto table_bytes = static_cast<size_t>(state.range(2));
+   const bool huge_pages = state.range(3) != 0;
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // the reduced hash selects one of the table's slots, i.e., each key incurs a random access
+   const memory::Buffer table(table_bytes, huge_pages);
+   const size_t slots = table_bytes / sizeof(std::uint64_t);
+   const auto* data = table.data<std::uint64_t>();
+
+   // type erased functions take Data keys, i.e., truncate like the templated benchmarks do implicitly
+   std::vector<Data> truncated;
+   const Data* keys;
+   if constexpr (std::is_same_v<Data, std::uint64_t>) {
+      keys = dataset.data();
+   } else {
+      truncated.assign(dataset.begin(), dataset.end());
+      keys = truncated.data();
+   }
+
+   // keys are hashed and reduced in batches, i.e., one indirect call per batch
+   constexpr size_t batch_size = 1024;
+   const auto& hashfn = hashing::registry::Registry<Data>::defaults().get(hashfn_name);
+   const auto reducer = hashing::registry::make_reducer(reducer_name, slots);
+   std::vector<HASH_64> indices(batch_size);
+
+   // like a hash table lookup, accesses of different keys are independent, i.e., the cpu may
+   // overlap their cache misses
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      std::uint64_t acc = 0;
+      for (size_t i = 0; i < dataset.size(); i += batch_size) {
+         const size_t cnt = std::min(batch_size, dataset.size() - i);
+         hashfn(keys + i, cnt, indices.data());
+         reducer(indices.data(), cnt, indices.data());
+         for (size_t j = 0; j < cnt; j++)
+            acc += data[indices[j]];
+      }
+      benchmark::DoNotOptimize(acc);
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["table_bytes"] = table_bytes;
+   state.counters["huge_pages"] = huge_pages;
+   state.counters["batch_size"] = batch_size;
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetLabel(hashfn_name + ":" + reducer_name + ":" + dataset::name(ds_id));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Hashfn, class Reductionfn, class Data>
+auto __BM_scattering = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
 
    const auto N = 100;
    std::array<size_t, N> buckets;
@@ -77,6 +348,8 @@ auto __BM_scattering = [](benchmark::State& state) {
    const Hashfn hashfn;
    const Reductionfn reductionfn(N);
 
+   perf::Counters counters;
+   counters.start();
    for (auto _ : state) {
       for (const auto& key : dataset) {
          const auto hash = hashfn(key);
@@ -84,12 +357,14 @@ auto __BM_scattering = [](benchmark::State& state) {
          buckets[index]++;
       }
    }
+   counters.stop();
 
    for (size_t i = 0; i < N; i++)
       state.counters["bucket_" + std::to_string(i)] = buckets[i];
 
    state.counters["dataset_size"] = dataset.size();
    state.SetLabel(Hashfn::name() + ":" + Reductionfn::name() + ":" + dataset::name(ds_id) + ":" + std::to_string(N));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
    state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
    state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
 };
@@ -99,20 +374,18 @@ auto __BM_biased_throughput = [](benchmark::State& state) {
    const auto ds_size = state.range(0);
    const auto ds_id = static_cast<dataset::ID>(state.range(1));
 
-   // load dataset
-   auto dataset = dataset::load_cached(ds_id, ds_size);
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
    if (dataset.empty())
       throw std::runtime_error("benchmark dataset empty");
 
-   // shuffle dataset
-   std::random_device rd_dev;
-   std::default_random_engine rng(rd_dev());
-   std::shuffle(dataset.begin(), dataset.end(), rng);
-
    const Hashfn hashfn(dataset.size());
 
    // alternatively, we could hash once per outer loop iteration. However, the overhead due to
    // gbench is too high for meaningful measurements of the fastest hashfns.
+   perf::Counters counters;
+   counters.start();
    for (auto _ : state) {
       for (const auto& key : dataset) {
          const auto index = hashfn(key);
@@ -120,9 +393,11 @@ auto __BM_biased_throughput = [](benchmark::State& state) {
          __sync_synchronize();
       }
    }
+   counters.stop();
 
    state.counters["dataset_size"] = dataset.size();
    state.SetLabel(Hashfn::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
    state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
    state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
 };
@@ -132,76 +407,460 @@ auto __BM_biased_scattering = [](benchmark::State& state) {
    const auto ds_size = state.range(0);
    const auto ds_id = static_cast<dataset::ID>(state.range(1));
 
-   // load dataset
-   auto dataset = dataset::load_cached(ds_id, ds_size);
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
    if (dataset.empty())
       throw std::runtime_error("benchmark dataset empty");
 
-   // shuffle dataset
-   std::random_device rd_dev;
-   std::default_random_engine rng(rd_dev());
-   std::shuffle(dataset.begin(), dataset.end(), rng);
-
    const auto N = 100;
    std::array<size_t, N> buckets;
    std::fill(buckets.begin(), buckets.end(), 0);
 
    const Hashfn hashfn(N);
 
+   perf::Counters counters;
+   counters.start();
    for (auto _ : state) {
       for (const auto& key : dataset) {
          const auto index = hashfn(key);
          buckets[index]++;
       }
    }
+   counters.stop();
 
    for (size_t i = 0; i < N; i++)
       state.counters["bucket_" + std::to_string(i)] = buckets[i];
 
    state.counters["dataset_size"] = dataset.size();
    state.SetLabel(Hashfn::name() + ":" + dataset::name(ds_id) + ":" + std::to_string(N));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Filter, class Data>
+auto __BM_filter = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // first half of the dataset is inserted, second half is only used to measure false positives
+   const auto members = dataset.size() / 2;
+   const Filter filter(std::vector<Data>(dataset.begin(), dataset.begin() + members));
+   std::unique_ptr<bool[]> result(new bool[dataset.size()]);
+
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      filter.contains(dataset.data(), dataset.size(), result.get());
+      benchmark::DoNotOptimize(result.get());
+   }
+   counters.stop();
+
+   size_t false_positives = 0;
+   for (size_t i = 0; i < dataset.size(); i++) {
+      if (i < members && !result[i])
+         throw std::runtime_error("filter " + Filter::name() + " reported a false negative");
+      false_positives += i >= members && result[i];
+   }
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["bits_per_key"] = 8.0 * filter.byte_size() / members;
+   state.counters["false_positive_rate"] = static_cast<double>(false_positives) / (dataset.size() - members);
+   state.SetLabel(Filter::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Sketch, class Data>
+auto __BM_sketch = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // sketches are fed two halves independently and merged, i.e., the way per thread sketches are combined
+   const auto half = dataset.size() / 2;
+   double estimate = 0;
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      Sketch left, right;
+      left.insert(dataset.data(), half);
+      right.insert(dataset.data() + half, dataset.size() - half);
+      left.merge(right);
+      estimate = left.cardinality();
+      benchmark::DoNotOptimize(estimate);
+   }
+   counters.stop();
+
+   // some datasets contain duplicates
+   auto sorted = dataset;
+   std::sort(sorted.begin(), sorted.end());
+   const auto distinct = std::distance(sorted.begin(), std::unique(sorted.begin(), sorted.end()));
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["relative_error"] = std::abs(estimate - static_cast<double>(distinct)) / distinct;
+   state.SetLabel(Sketch::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
+};
+
+template<class Hashfn>
+auto __BM_string_throughput = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::StringID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   const Hashfn hashfn;
+   size_t bytes = 0;
+   for (const auto& key : dataset)
+      bytes += key.size();
+
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      for (const auto& key : dataset) {
+         const auto hash = hashfn(std::string_view(key));
+         benchmark::DoNotOptimize(hash);
+         __sync_synchronize();
+      }
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["avg_key_length"] = static_cast<double>(bytes) / static_cast<double>(dataset.size());
+   state.SetLabel(Hashfn::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(bytes * static_cast<size_t>(state.iterations()));
+};
+
+template<class Hashfn>
+auto __BM_string_columnar = [](benchmark::State& state) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::StringID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // convert to columnar layout
+   std::vector<std::int64_t> offsets{0};
+   std::string bytes;
+   offsets.reserve(dataset.size() + 1);
+   for (const auto& key : dataset) {
+      bytes += key;
+      offsets.push_back(static_cast<std::int64_t>(bytes.size()));
+   }
+
+   const hashing::columnar::ColumnHasher<Hashfn, std::int64_t> hasher;
+   std::vector<typename decltype(hasher)::Result> hashes(dataset.size());
+
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      hasher(offsets.data(), bytes.data(), dataset.size(), hashes.data());
+      benchmark::DoNotOptimize(hashes.data());
+      benchmark::ClobberMemory();
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["avg_key_length"] = static_cast<double>(bytes.size()) / static_cast<double>(dataset.size());
+   state.SetLabel(decltype(hasher)::name() + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
+   state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
+   state.SetBytesProcessed(bytes.size() * static_cast<size_t>(state.iterations()));
+};
+
+template<class Table>
+auto __BM_table = [](benchmark::State& state, const std::string& hashfn_name, const std::string& reducer_name) {
+   using Data = std::uint64_t;
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+   const double load_factor = static_cast<double>(state.range(2)) / 100.0;
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   std::random_device rd_dev;
+   std::default_random_engine rng(rd_dev());
+
+   // first half of the dataset is inserted, second half is only used for unsuccessful lookups
+   const size_t members = dataset.size() / 2;
+   const size_t buckets = Table::buckets(members, load_factor);
+   const auto& hashfn = hashing::registry::Registry<Data>::defaults().get(hashfn_name);
+   const auto reducer = hashing::registry::make_reducer(reducer_name, buckets);
+
+   // keys are hashed and reduced in batches, i.e., one indirect call per batch. Tables
+   // with two choices derive their alternative bucket from the remixed hash
+   constexpr size_t batch_size = 1024;
+   std::vector<HASH_64> hashes(batch_size), indices(batch_size), alt_indices(batch_size);
+   const auto hash_batch = [&](const Data* keys, const size_t& n) {
+      hashfn(keys, n, hashes.data());
+      reducer(hashes.data(), n, indices.data());
+      if constexpr (Table::Choices > 1) {
+         for (size_t i = 0; i < n; i++)
+            hashes[i] = hashing::MurmurFinalizer<HASH_64>()(hashes[i]);
+         reducer(hashes.data(), n, alt_indices.data());
+      }
+   };
+
+   struct Stats {
+      size_t probes = 0;
+      size_t max_probes = 0;
+      double ns = 0;
+   };
+   Stats insert, hit, miss;
+   const auto lookup = [&](const Table& table, const Data* keys, const size_t& n, const bool expected,
+                           Stats& stats) {
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < n; i += batch_size) {
+         const size_t cnt = std::min(batch_size, n - i);
+         hash_batch(keys + i, cnt);
+         for (size_t j = 0; j < cnt; j++) {
+            const auto probe = table.lookup(keys[i + j], indices[j], alt_indices[j]);
+            if (unlikely(probe.found != expected))
+               throw std::runtime_error(Table::name() + " lookup returned wrong result");
+            stats.probes += probe.probes;
+            stats.max_probes = std::max(stats.max_probes, probe.probes);
+         }
+      }
+      stats.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+   };
+
+   for (auto _ : state) {
+      Table table(buckets);
+
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < members; i += batch_size) {
+         const size_t cnt = std::min(batch_size, members - i);
+         hash_batch(dataset.data() + i, cnt);
+         for (size_t j = 0; j < cnt; j++) {
+            const auto probes = table.insert(dataset[i + j], indices[j], alt_indices[j]);
+            if (unlikely(probes == 0)) {
+               state.SkipWithError((Table::name() + " insert failed").c_str());
+               return;
+            }
+            insert.probes += probes;
+            insert.max_probes = std::max(insert.max_probes, probes);
+         }
+      }
+      insert.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+      // successful lookups in a different order than insertion
+      std::vector<Data> members_shuffled(dataset.begin(), dataset.begin() + members);
+      parallel::shuffle(members_shuffled, rng);
+      lookup(table, members_shuffled.data(), members, true, hit);
+      lookup(table, dataset.data() + members, dataset.size() - members, false, miss);
+   }
+
+   const double inserts = static_cast<double>(members) * static_cast<double>(state.iterations());
+   const double misses = static_cast<double>(dataset.size() - members) * static_cast<double>(state.iterations());
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["load_factor"] = load_factor;
+   state.counters["insert_ns"] = insert.ns / inserts;
+   state.counters["insert_probes_avg"] = static_cast<double>(insert.probes) / inserts;
+   state.counters["insert_probes_max"] = insert.max_probes;
+   state.counters["hit_ns"] = hit.ns / inserts;
+   state.counters["hit_probes_avg"] = static_cast<double>(hit.probes) / inserts;
+   state.counters["hit_probes_max"] = hit.max_probes;
+   state.counters["miss_ns"] = miss.ns / misses;
+   state.counters["miss_probes_avg"] = static_cast<double>(miss.probes) / misses;
+   state.counters["miss_probes_max"] = miss.max_probes;
+   state.SetLabel(Table::name() + ":" + hashfn_name + ":" + reducer_name + ":" + dataset::name(ds_id));
+};
+
+template<class Data>
+auto __BM_registry = [](benchmark::State& state, const std::string& hashfn_name) {
+   const auto ds_size = state.range(0);
+   const auto ds_id = static_cast<dataset::ID>(state.range(1));
+
+   // load shuffled dataset (shared between benchmarks, i.e., not copied)
+   const auto shuffled = dataset::load_shuffled(ds_id, ds_size);
+   const auto& dataset = *shuffled;
+   if (dataset.empty())
+      throw std::runtime_error("benchmark dataset empty");
+
+   // type erased functions take Data keys, i.e., truncate like the templated benchmarks do implicitly
+   const std::vector<Data> keys(dataset.begin(), dataset.end());
+
+   // one indirect call per batch of keys
+   constexpr size_t batch_size = 1024;
+   const auto& hashfn = hashing::registry::Registry<Data>::defaults().get(hashfn_name);
+   std::vector<HASH_64> hashes(batch_size);
+
+   perf::Counters counters;
+   counters.start();
+   for (auto _ : state) {
+      for (size_t i = 0; i < keys.size(); i += batch_size) {
+         hashfn(keys.data() + i, std::min(batch_size, keys.size() - i), hashes.data());
+         benchmark::DoNotOptimize(hashes.data());
+         benchmark::ClobberMemory();
+      }
+   }
+   counters.stop();
+
+   state.counters["dataset_size"] = dataset.size();
+   state.counters["batch_size"] = batch_size;
+   state.SetLabel(hashfn_name + ":" + dataset::name(ds_id));
+   counters.report(state, static_cast<double>(dataset.size()) * static_cast<double>(state.iterations()));
    state.SetItemsProcessed(dataset.size() * static_cast<size_t>(state.iterations()));
    state.SetBytesProcessed(dataset.size() * static_cast<size_t>(state.iterations()) * sizeof(Data));
 };
 
-#define BENCHMARK_UNIFORM(Hashfn)                                                                            \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
-                                __BM_throughput<Hashfn, hashing::reduction::DoNothing<T>, T>)                \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
-      ->Repetitions(10);                                                                                     \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
-                                __BM_throughput<Hashfn, hashing::reduction::Fastrange<T>, T>)                \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
-      ->Repetitions(10);                                                                                     \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
-                                __BM_throughput<Hashfn, hashing::reduction::Modulo<T>, T>)                   \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
-      ->Repetitions(10);                                                                                     \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
-                                __BM_throughput<Hashfn, hashing::reduction::FastModulo<T>, T>)               \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
-      ->Repetitions(10);                                                                                     \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
-                                __BM_throughput<Hashfn, hashing::reduction::BranchlessFastModulo<T>, T>)     \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
-      ->Repetitions(10);                                                                                     \
-   benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::Fastrange<T>, T>)  \
-      ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
-      ->Iterations(1);                                                                                       \
-   benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::Modulo<T>, T>)     \
-      ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
-      ->Iterations(1);                                                                                       \
-   benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::FastModulo<T>, T>) \
-      ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
-      ->Iterations(1);
-
-#define BENCHMARK_BIASED(Hashfn)                                                                  \
-   benchmark::RegisterBenchmark("throughput_sync_synchronize", __BM_biased_throughput<Hashfn, T>) \
-      ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                         \
-      ->Repetitions(10);                                                                          \
-   benchmark::RegisterBenchmark("scattering_sync_synchronize", __BM_biased_scattering<Hashfn, T>) \
-      ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                         \
-      ->Iterations(1);
+// functions this cpu does not support (see dispatch::supported, e.g., AquaHash without
+// AES-NI or HASHING_DISPATCH=scalar) are skipped instead of raising SIGILL
+#define BENCHMARK_UNIFORM(Hashfn)                                                                               \
+   if (hashing::dispatch::supported<Hashfn>()) {                                                                \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
+                                   __BM_throughput<Hashfn, hashing::reduction::DoNothing<T>, T>)                \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
+                                   __BM_throughput<Hashfn, hashing::reduction::Fastrange<T>, T>)                \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
+                                   __BM_throughput<Hashfn, hashing::reduction::Modulo<T>, T>)                   \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
+                                   __BM_throughput<Hashfn, hashing::reduction::FastModulo<T>, T>)               \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize",                                               \
+                                   __BM_throughput<Hashfn, hashing::reduction::BranchlessFastModulo<T>, T>)     \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_nofence",                                                        \
+                                   __BM_throughput_nofence<Hashfn, hashing::reduction::DoNothing<T>, T>)        \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("throughput_nofence",                                                        \
+                                   __BM_throughput_nofence<Hashfn, hashing::reduction::Fastrange<T>, T>)        \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("latency", __BM_latency<Hashfn, hashing::reduction::DoNothing<T>, T>)        \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("latency", __BM_latency<Hashfn, hashing::reduction::Fastrange<T>, T>)        \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                                    \
+         ->Repetitions(10);                                                                                     \
+      benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::Fastrange<T>, T>)  \
+         ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
+         ->Iterations(1);                                                                                       \
+      benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::Modulo<T>, T>)     \
+         ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
+         ->Iterations(1);                                                                                       \
+      benchmark::RegisterBenchmark("scattering", __BM_scattering<Hashfn, hashing::reduction::FastModulo<T>, T>) \
+         ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                                    \
+         ->Iterations(1);                                                                                       \
+   }
+
+// every registered function with every reducer producing indices in [0, N) that matches its
+// output width. Threads are either placed on distinct physical cores or, if smt siblings are
+// available, fill up one physical core after another
+#define BENCHMARK_SCALING()                                                                             \
+   for (const auto& hashfn_name : hashing::registry::Registry<T>::defaults().names())                   \
+      for (const auto& reducer_name : hashing::registry::range_reducer_names(                           \
+              hashing::registry::Registry<T>::defaults().bits(hashfn_name)))                            \
+         for (const bool smt : {false, true}) {                                                         \
+            const size_t max_threads = threads::cpus(smt).size();                                       \
+            if (smt && max_threads == threads::cpus(false).size())                                      \
+               continue;                                                                                \
+            benchmark::RegisterBenchmark("scaling", __BM_scaling<T>, hashfn_name, reducer_name)         \
+               ->ArgsProduct({throughput_ds_sizes, throughput_ds, threads::counts(max_threads), {smt}}) \
+               ->UseRealTime()                                                                          \
+               ->Repetitions(3);                                                                        \
+         }
+
+// every registered function with every reducer producing indices in [0, N) that matches its
+// output width. Huge pages are only requested for tables spanning at least one huge page,
+// smaller ones can not be backed by a huge page
+#define BENCHMARK_WORKING_SET()                                                                         \
+   for (const auto& hashfn_name : hashing::registry::Registry<T>::defaults().names())                   \
+      for (const auto& reducer_name : hashing::registry::range_reducer_names(                           \
+              hashing::registry::Registry<T>::defaults().bits(hashfn_name)))                            \
+         for (const auto& table_bytes : working_set_bytes)                                              \
+            benchmark::RegisterBenchmark("working_set", __BM_working_set<T>, hashfn_name, reducer_name) \
+               ->ArgsProduct({working_set_ds_sizes, throughput_ds, {table_bytes},                       \
+                              table_bytes >= static_cast<std::int64_t>(memory::HugePageSize)            \
+                                 ? std::vector<std::int64_t>{0, 1}                                      \
+                                 : std::vector<std::int64_t>{0}})                                       \
+               ->Repetitions(3);
+
+#define BENCHMARK_BIASED(Hashfn)                                                                     \
+   if (hashing::dispatch::supported<Hashfn>()) {                                                     \
+      benchmark::RegisterBenchmark("throughput_sync_synchronize", __BM_biased_throughput<Hashfn, T>) \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                                         \
+         ->Repetitions(10);                                                                          \
+      benchmark::RegisterBenchmark("scattering_sync_synchronize", __BM_biased_scattering<Hashfn, T>) \
+         ->ArgsProduct({scattering_ds_sizes, scattering_ds})                                         \
+         ->Iterations(1);                                                                            \
+   }
+
+#define BENCHMARK_FILTER(...)                                          \
+   benchmark::RegisterBenchmark("filter", __BM_filter<__VA_ARGS__, T>) \
+      ->ArgsProduct({filter_ds_sizes, filter_ds})                      \
+      ->Repetitions(3);
+
+#define BENCHMARK_STRING(Hashfn)                                                        \
+   if (hashing::dispatch::supported<Hashfn>()) {                                        \
+      benchmark::RegisterBenchmark("string_throughput", __BM_string_throughput<Hashfn>) \
+         ->ArgsProduct({string_ds_sizes, string_ds});                                   \
+   }
+
+#define BENCHMARK_STRING_COLUMNAR(Hashfn)                                           \
+   if (hashing::dispatch::supported<Hashfn>()) {                                    \
+      benchmark::RegisterBenchmark("string_columnar", __BM_string_columnar<Hashfn>) \
+         ->ArgsProduct({string_ds_sizes, string_ds});                               \
+   }
+
+#define BENCHMARK_REGISTRY()                                                     \
+   for (const auto& name : hashing::registry::Registry<T>::defaults().names()) \
+      benchmark::RegisterBenchmark("registry", __BM_registry<T>, name)          \
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})                   \
+         ->Repetitions(3);
+
+// every registered function with every reducer producing indices in [0, N) that matches
+// its output width, e.g., 32-bit hashes are reduced by fastrange32 instead of fastrange64
+#define BENCHMARK_TABLE(Table)                                                                                   \
+   for (const auto& hashfn_name : hashing::registry::Registry<std::uint64_t>::defaults().names())               \
+      for (const auto& reducer_name : hashing::registry::range_reducer_names(                                   \
+              hashing::registry::Registry<std::uint64_t>::defaults().bits(hashfn_name)))                        \
+         benchmark::RegisterBenchmark(("table_" + Table::name()).c_str(), __BM_table<Table>, hashfn_name,       \
+                                      reducer_name)                                                             \
+            ->ArgsProduct({table_ds_sizes, table_ds, table_load_factors})                                       \
+            ->Iterations(1);
+
+#define BENCHMARK_SKETCH(...)                                          \
+   benchmark::RegisterBenchmark("sketch", __BM_sketch<__VA_ARGS__, T>) \
+      ->ArgsProduct({sketch_ds_sizes, sketch_ds})                      \
+      ->Repetitions(3);
 
 template<class T>
 struct DoNothing {
@@ -215,14 +874,21 @@ struct DoNothing {
 };
 
 int main(int argc, char** argv) {
-   // used to measure __sync_synchronize overhead
    {
       using T = HASH_32;
 
+      // baselines, i.e., __sync_synchronize overhead and loop/dependency overhead
       benchmark::RegisterBenchmark("throughput_sync_synchronize",
                                    __BM_throughput<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
          ->ArgsProduct({throughput_ds_sizes, throughput_ds})
          ->Repetitions(10);
+      benchmark::RegisterBenchmark("throughput_nofence",
+                                   __BM_throughput_nofence<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})
+         ->Repetitions(10);
+      benchmark::RegisterBenchmark("latency", __BM_latency<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})
+         ->Repetitions(10);
 
       BENCHMARK_BIASED(hashing::MultPrime32);
       BENCHMARK_BIASED(hashing::Fibonacci32);
@@ -233,15 +899,27 @@ int main(int argc, char** argv) {
       BENCHMARK_UNIFORM(hashing::CityHash32<T>);
       BENCHMARK_UNIFORM(hashing::MeowHash32<T>);
       BENCHMARK_UNIFORM(hashing::TabulationHash<T>);
+
+      BENCHMARK_REGISTRY();
+
+      BENCHMARK_SCALING();
    }
 
    {
       using T = HASH_64;
 
+      // baselines, i.e., __sync_synchronize overhead and loop/dependency overhead
       benchmark::RegisterBenchmark("throughput_sync_synchronize",
                                    __BM_throughput<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
          ->ArgsProduct({throughput_ds_sizes, throughput_ds})
          ->Repetitions(10);
+      benchmark::RegisterBenchmark("throughput_nofence",
+                                   __BM_throughput_nofence<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})
+         ->Repetitions(10);
+      benchmark::RegisterBenchmark("latency", __BM_latency<DoNothing<T>, hashing::reduction::DoNothing<T>, T>)
+         ->ArgsProduct({throughput_ds_sizes, throughput_ds})
+         ->Repetitions(10);
 
       BENCHMARK_BIASED(hashing::MultPrime64);
       BENCHMARK_BIASED(hashing::Fibonacci64);
@@ -252,6 +930,42 @@ int main(int argc, char** argv) {
       BENCHMARK_UNIFORM(hashing::CityHash64<T>);
       BENCHMARK_UNIFORM(hashing::MeowHash64<T>);
       BENCHMARK_UNIFORM(hashing::TabulationHash<T>);
+
+      BENCHMARK_REGISTRY();
+
+      BENCHMARK_WORKING_SET();
+
+      BENCHMARK_SCALING();
+
+      BENCHMARK_STRING(hashing::XXHash3<T>);
+      BENCHMARK_STRING(hashing::XXHash64<T>);
+      BENCHMARK_STRING(hashing::CityHash64<T>);
+      BENCHMARK_STRING(hashing::AquaHash<T>);
+      BENCHMARK_STRING(hashing::MeowHash64<T>);
+      BENCHMARK_STRING(hashing::Murmur3Hash128<>);
+
+      BENCHMARK_STRING_COLUMNAR(hashing::XXHash3<T>);
+      BENCHMARK_STRING_COLUMNAR(hashing::CityHash64<T>);
+      BENCHMARK_STRING_COLUMNAR(hashing::AquaHash<T>);
+
+      BENCHMARK_FILTER(hashing::filter::BlockedBloom<T, hashing::XXHash3<T>>);
+      BENCHMARK_FILTER(hashing::filter::BlockedBloom<T, hashing::MurmurFinalizer<T>>);
+      BENCHMARK_FILTER(hashing::filter::XorFilter8<T, hashing::XXHash3<T>>);
+      BENCHMARK_FILTER(hashing::filter::XorFilter16<T, hashing::XXHash3<T>>);
+      BENCHMARK_FILTER(hashing::filter::BinaryFuse8<T, hashing::XXHash3<T>>);
+      BENCHMARK_FILTER(hashing::filter::BinaryFuse16<T, hashing::XXHash3<T>>);
+      BENCHMARK_FILTER(hashing::filter::BinaryFuse8<T, hashing::MurmurFinalizer<T>>);
+      BENCHMARK_FILTER(hashing::filter::CuckooFilter<T, hashing::XXHash3<T>, 8>);
+      BENCHMARK_FILTER(hashing::filter::CuckooFilter<T, hashing::XXHash3<T>, 12>);
+      BENCHMARK_FILTER(hashing::filter::CuckooFilter<T, hashing::XXHash3<T>, 16>);
+
+      BENCHMARK_SKETCH(hashing::sketch::HyperLogLog<T, hashing::XXHash3<T>>);
+      BENCHMARK_SKETCH(hashing::sketch::HyperLogLog<T, hashing::XXHash3<T>, 18>);
+      BENCHMARK_SKETCH(hashing::sketch::HyperLogLog<T, hashing::MurmurFinalizer<T>>);
+
+      BENCHMARK_TABLE(tables::LinearProbing<T>);
+      BENCHMARK_TABLE(tables::Chaining<T>);
+      BENCHMARK_TABLE(tables::Cuckoo<T>);
    }
 
    benchmark::Initialize(&argc, argv);
@@ -1,94 +1,306 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <random>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "include/file.hpp"
+
+#include "./parallel.hpp"
+
+// Order important
 #include "include/convenience/builtins.hpp"
 
+// progress is reported on stderr, i.e., stdout is reserved for results (e.g., ha_quality's csv)
 namespace dataset {
+   /**
+    * Sorts vec and removes duplicates, multithreaded for large inputs (see parallel.hpp)
+    */
    template<class T>
    static void sort_and_deduplicate(std::vector<T>& vec) {
-      std::sort(vec.begin(), vec.end());
-      vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
-      vec.shrink_to_fit();
+      parallel::sort_and_deduplicate(vec);
    }
 
+   /**
+    * SOSD dataset file mapped into memory, i.e., keys are accessed in place instead of
+    * being parsed and copied. Files consist of an 8 byte key count followed by the keys,
+    * both in little endian byte order
+    */
+   template<class Key>
+   struct MappedDataset {
+      static_assert(std::endian::native == std::endian::little, "keys are accessed in place");
+
+      /**
+       * @throws std::runtime_error if the file can not be mapped or is truncated
+       */
+      explicit MappedDataset(const std::string& filepath) : file(filepath, true) {
+         // hint only, file backed huge pages depend on the kernel and file system
+         file.advise(MADV_HUGEPAGE);
+
+         std::uint64_t count = 0;
+         if (file.size() < sizeof(count))
+            throw std::runtime_error("dataset '" + filepath + "' is truncated");
+         std::memcpy(&count, file.data(), sizeof(count));
+         if (count > (file.size() - sizeof(count)) / sizeof(Key))
+            throw std::runtime_error("dataset '" + filepath + "' is truncated");
+
+         keys_ = {reinterpret_cast<const Key*>(file.data() + sizeof(count)), static_cast<size_t>(count)};
+
+         // single pass determining whether keys are sorted and, if so, how many are distinct
+         sorted_ = true;
+         distinct_ = keys_.empty() ? 0 : 1;
+         for (size_t i = 1; i < keys_.size() && sorted_; i++) {
+            sorted_ = keys_[i - 1] <= keys_[i];
+            distinct_ += keys_[i - 1] != keys_[i];
+         }
+      }
+
+      std::span<const Key> keys() const {
+         return keys_;
+      }
+
+      size_t size() const {
+         return keys_.size();
+      }
+
+      /// SOSD datasets are sorted, which allows deduplicating and sampling without sorting
+      bool sorted() const {
+         return sorted_;
+      }
+
+      /**
+       * @return amount of distinct keys, only available for sorted datasets
+       */
+      size_t distinct() const {
+         assert(sorted_);
+         return distinct_;
+      }
+
+     private:
+      hashing::file::MappedFile file;
+      std::span<const Key> keys_;
+      bool sorted_;
+      size_t distinct_ = 0;
+   };
+
    /**
     * Loads the datasets values into memory
     * @return a sorted and deduplicated list of all members of the dataset
     */
    template<class Key>
    std::vector<Key> load(const std::string& filepath) {
-      std::cout << "loading dataset " << filepath << std::endl;
-
-      // parsing helper functions
-      auto read_little_endian_8 = [](const std::vector<unsigned char>& buffer, uint64_t offset) {
-         return static_cast<uint64_t>(buffer[offset + 0]) | (static_cast<uint64_t>(buffer[offset + 1]) << 8) |
-            (static_cast<uint64_t>(buffer[offset + 2]) << (2 * 8)) |
-            (static_cast<uint64_t>(buffer[offset + 3]) << (3 * 8)) |
-            (static_cast<uint64_t>(buffer[offset + 4]) << (4 * 8)) |
-            (static_cast<uint64_t>(buffer[offset + 5]) << (5 * 8)) |
-            (static_cast<uint64_t>(buffer[offset + 6]) << (6 * 8)) |
-            (static_cast<uint64_t>(buffer[offset + 7]) << (7 * 8));
-      };
-      auto read_little_endian_4 = [](const std::vector<unsigned char>& buffer, uint64_t offset) {
-         return buffer[offset + 0] | (buffer[offset + 1] << 8) | (buffer[offset + 2] << (2 * 8)) |
-            (buffer[offset + 3] << (3 * 8));
-      };
+      std::cerr << "loading dataset " << filepath << std::endl;
 
-      // Read file into memory from disk. Directly map file for more performance
-      std::ifstream input(filepath, std::ios::binary | std::ios::ate);
-      std::streamsize size = input.tellg();
-      input.seekg(0, std::ios::beg);
-      if (!input.is_open()) {
+      if (!std::filesystem::exists(filepath)) {
          std::cerr << "file '" + filepath + "' does not exist" << std::endl;
          return {};
       }
 
-      const auto max_num_elements = (size - sizeof(std::uint64_t)) / sizeof(Key);
-      std::vector<uint64_t> dataset(max_num_elements, 0);
-      {
-         std::vector<unsigned char> buffer(size);
-         if (!input.read(reinterpret_cast<char*>(buffer.data()), size))
-            throw std::runtime_error("Failed to read dataset '" + filepath + "'");
-
-         // Parse file
-         uint64_t num_elements = read_little_endian_8(buffer, 0);
-         assert(num_elements <= max_num_elements);
-         switch (sizeof(Key)) {
-            case sizeof(std::uint64_t):
-               for (uint64_t i = 0; i < num_elements; i++) {
-                  // 8 byte header, 8 bytes per entry
-                  uint64_t offset = i * 8 + 8;
-                  dataset[i] = read_little_endian_8(buffer, offset);
-               }
-               break;
-            case sizeof(std::uint32_t):
-               for (uint64_t i = 0; i < num_elements; i++) {
-                  // 8 byte header, 4 bytes per entry
-                  uint64_t offset = i * 4 + 8;
-                  dataset[i] = read_little_endian_4(buffer, offset);
-               }
-               break;
-            default:
-               throw std::runtime_error("unimplemented amount of bytes per value in dataset: " +
-                                        std::to_string(sizeof(Key)));
+      const MappedDataset<Key> mapped(filepath);
+      const auto keys = mapped.keys();
+      std::vector<Key> dataset;
+      if (mapped.sorted()) {
+         dataset.reserve(keys.size());
+         std::unique_copy(keys.begin(), keys.end(), std::back_inserter(dataset));
+         dataset.shrink_to_fit();
+      } else {
+         dataset.assign(keys.begin(), keys.end());
+         sort_and_deduplicate(dataset);
+      }
+
+      return dataset;
+   }
+
+   /**
+    * Draws n distinct keys uniformly at random from a mapped dataset. For sorted datasets,
+    * only the sampled keys are copied: a drawn position is accepted if it holds the first
+    * occurrence of its key, i.e., each distinct key is equally likely to be drawn
+    *
+    * @return up to n distinct keys in ascending order
+    */
+   template<class Data, class Key, class RNG>
+   std::vector<Data> sample(const MappedDataset<Key>& mapped, const size_t n, RNG& rng) {
+      const auto keys = mapped.keys();
+
+      // rejection sampling degrades once a large fraction of all distinct keys is requested
+      // and never terminates if there are fewer than n
+      if (!mapped.sorted() || n * 2 >= mapped.distinct()) {
+         std::vector<Key> distinct;
+         if (mapped.sorted()) {
+            std::unique_copy(keys.begin(), keys.end(), std::back_inserter(distinct));
+         } else {
+            distinct.assign(keys.begin(), keys.end());
+            sort_and_deduplicate(distinct);
          }
+         parallel::shuffle(distinct, rng);
+         distinct.resize(std::min(n, distinct.size()));
+
+         std::vector<Data> res(distinct.begin(), distinct.end());
+         sort_and_deduplicate(res);
+         return res;
       }
 
-      sort_and_deduplicate(dataset);
+      std::uniform_int_distribution<size_t> dist(0, keys.size() - 1);
+      std::vector<size_t> positions;
+      positions.reserve(n);
+      while (positions.size() < n) {
+         for (size_t missing = n - positions.size(); missing > 0; missing--) {
+            const auto pos = dist(rng);
+            if (pos == 0 || keys[pos - 1] != keys[pos])
+               positions.push_back(pos);
+         }
+         sort_and_deduplicate(positions);
+      }
 
-      return dataset;
+      std::vector<Data> res;
+      res.reserve(n);
+      for (const auto& pos : positions)
+         res.push_back(static_cast<Data>(keys[pos]));
+      sort_and_deduplicate(res);
+      return res;
    }
 
+   /**
+    * Maps each SOSD dataset file once and keeps it mapped, i.e., in the page cache
+    * @return the mapping or nullptr if the file does not exist
+    */
+   inline const MappedDataset<std::uint64_t>* load_mapped(const std::string& filepath) {
+      static std::unordered_map<std::string, std::unique_ptr<MappedDataset<std::uint64_t>>> mapped;
+
+      const auto it = mapped.find(filepath);
+      if (it != mapped.end())
+         return it->second.get();
+
+      std::cerr << "mapping dataset " << filepath << std::endl;
+      if (!std::filesystem::exists(filepath)) {
+         std::cerr << "file '" + filepath + "' does not exist" << std::endl;
+         return mapped.emplace(filepath, nullptr).first->second.get();
+      }
+      return mapped.emplace(filepath, std::make_unique<MappedDataset<std::uint64_t>>(filepath)).first->second.get();
+   }
+
+   /**
+    * Least recently used cache for generated datasets of all key types. Datasets are handed
+    * out as shared, immutable vectors or spans, i.e., callers never copy them and evicting a
+    * dataset only frees (or unmaps) it once no caller holds it anymore. The budget defaults to half of the
+    * physical memory and may be overridden (in bytes) by the HASHING_DATASET_CACHE_BYTES
+    * environment variable
+    */
+   struct Cache {
+      static Cache& instance() {
+         static Cache cache;
+         return cache;
+      }
+
+      /**
+       * @return the cached dataset or nullptr
+       */
+      template<class Keys>
+      std::shared_ptr<const Keys> get(const std::string& key) {
+         const auto it = entries.find(key);
+         if (it == entries.end())
+            return nullptr;
+         it->second.last_use = ++clock;
+         return std::static_pointer_cast<const Keys>(it->second.data);
+      }
+
+      /**
+       * Caches data under key, evicting the least recently used datasets to stay within
+       * the budget. Datasets larger than the entire budget are not cached
+       */
+      template<class Keys>
+      void put(const std::string& key, std::shared_ptr<const Keys> data) {
+         erase(key);
+         const size_t bytes = footprint(*data);
+         if (bytes > budget)
+            return;
+
+         while (used + bytes > budget) {
+            auto lru = entries.begin();
+            for (auto it = entries.begin(); it != entries.end(); it++)
+               if (it->second.last_use < lru->second.last_use)
+                  lru = it;
+            std::cerr << "evicting dataset " << lru->first << " from cache" << std::endl;
+            erase(lru->first);
+         }
+
+         entries.emplace(key, Entry{std::move(data), bytes, ++clock});
+         used += bytes;
+      }
+
+      size_t budget_bytes() const {
+         return budget;
+      }
+
+      size_t used_bytes() const {
+         return used;
+      }
+
+     private:
+      struct Entry {
+         std::shared_ptr<const void> data;
+         size_t bytes;
+         size_t last_use;
+      };
+
+      std::unordered_map<std::string, Entry> entries;
+      size_t budget;
+      size_t used = 0;
+      size_t clock = 0;
+
+      Cache() {
+         const char* env = std::getenv("HASHING_DATASET_CACHE_BYTES");
+         if (env != nullptr) {
+            budget = std::strtoull(env, nullptr, 0);
+            return;
+         }
+         const auto pages = ::sysconf(_SC_PHYS_PAGES);
+         const auto page_size = ::sysconf(_SC_PAGE_SIZE);
+         budget = pages > 0 && page_size > 0 ? static_cast<size_t>(pages) * static_cast<size_t>(page_size) / 2
+                                             : std::numeric_limits<size_t>::max();
+      }
+
+      void erase(const std::string& key) {
+         const auto it = entries.find(key);
+         if (it == entries.end())
+            return;
+         used -= it->second.bytes;
+         entries.erase(it);
+      }
+
+      template<class Keys>
+      static size_t footprint(const Keys& keys) {
+         using T = typename Keys::value_type;
+         size_t bytes = keys.size() * sizeof(T);
+         if constexpr (requires { keys.capacity(); })
+            bytes = keys.capacity() * sizeof(T);
+         if constexpr (std::is_same_v<T, std::string>)
+            for (const auto& str : keys)
+               // short strings are stored inline
+               if (str.capacity() >= sizeof(std::string))
+                  bytes += str.capacity() + 1;
+         return bytes;
+      }
+   };
+
    enum class ID
    {
       SEQUENTIAL = 0,
@@ -123,25 +335,21 @@ namespace dataset {
       return "unnamed";
    };
 
-   template<class Data = std::uint64_t>
-   std::vector<Data> load_cached(ID id, size_t dataset_size) {
-      static std::random_device rd;
-      static std::default_random_engine rng(rd());
-
-      // cache generated & sampled datasets to speed up repeated benchmarks
-      static std::unordered_map<ID, std::unordered_map<size_t, std::vector<Data>>> datasets;
-
-      // cache sosd dataset files to avoid expensive load operations
-      static std::vector<Data> ds_fb, ds_osm, ds_wiki, ds_books;
-
-      // return cached (if available)
-      const auto id_it = datasets.find(id);
-      if (id_it != datasets.end()) {
-         const auto ds_it = id_it->second.find(dataset_size);
-         if (ds_it != id_it->second.end())
-            return ds_it->second;
-      }
+   /**
+    * @return cache key of the dataset with the given name, key type and size
+    */
+   template<class Data>
+   std::string cache_key(const std::string& ds_name, const size_t& dataset_size, const bool& shuffled) {
+      std::string key_type;
+      if constexpr (std::is_same_v<Data, std::string>)
+         key_type = "str";
+      else
+         key_type = "u" + std::to_string(sizeof(Data) * 8);
+      return ds_name + "_" + key_type + "_" + std::to_string(dataset_size) + (shuffled ? "_shuffled" : "");
+   }
 
+   template<class Data = std::uint64_t, class RNG>
+   std::vector<Data> generate(ID id, size_t dataset_size, RNG& rng) {
       // generate (or random sample) in appropriate size
       std::vector<Data> ds(dataset_size, 0);
       switch (id) {
@@ -186,59 +394,35 @@ namespace dataset {
             break;
          }
          case ID::FB: {
-            if (ds_fb.empty()) {
-               ds_fb = load<Data>("data/fb_200M_uint64");
-               std::shuffle(ds_fb.begin(), ds_fb.end(), rng);
-            }
+            const auto* mapped = load_mapped("data/fb_200M_uint64");
             // ds file does not exist
-            if (ds_fb.empty())
+            if (mapped == nullptr)
                return {};
-
-            // sampling this way is only valid since ds_fb is shuffled!
-            for (size_t i = 0; i < ds_fb.size() && i < ds.size(); i++)
-               ds[i] = ds_fb[i];
+            ds = sample<Data>(*mapped, dataset_size, rng);
             break;
          }
          case ID::OSM: {
-            if (ds_osm.empty()) {
-               ds_osm = load<Data>("data/osm_cellids_200M_uint64");
-               std::shuffle(ds_osm.begin(), ds_osm.end(), rng);
-            }
+            const auto* mapped = load_mapped("data/osm_cellids_200M_uint64");
             // ds file does not exist
-            if (ds_osm.empty())
+            if (mapped == nullptr)
                return {};
-
-            // sampling this way is only valid since ds_osm is shuffled!
-            for (size_t i = 0; i < ds_osm.size() && i < ds.size(); i++)
-               ds[i] = ds_osm[i];
+            ds = sample<Data>(*mapped, dataset_size, rng);
             break;
          }
          case ID::WIKI: {
-            if (ds_wiki.empty()) {
-               ds_wiki = load<Data>("data/wiki_ts_200M_uint64");
-               std::shuffle(ds_wiki.begin(), ds_wiki.end(), rng);
-            }
+            const auto* mapped = load_mapped("data/wiki_ts_200M_uint64");
             // ds file does not exist
-            if (ds_wiki.empty())
+            if (mapped == nullptr)
                return {};
-
-            // sampling this way is only valid since ds_wiki is shuffled!
-            for (size_t i = 0; i < ds_wiki.size() && i < ds.size(); i++)
-               ds[i] = ds_wiki[i];
+            ds = sample<Data>(*mapped, dataset_size, rng);
             break;
          }
          case ID::BOOKS: {
-            if (ds_books.empty()) {
-               ds_books = load<Data>("data/books_200M_uint64");
-               std::shuffle(ds_books.begin(), ds_books.end(), rng);
-            }
+            const auto* mapped = load_mapped("data/books_200M_uint64");
             // ds file does not exist
-            if (ds_books.empty())
+            if (mapped == nullptr)
                return {};
-
-            // sampling this way is only valid since ds_wiki is shuffled!
-            for (size_t i = 0; i < ds_books.size() && i < ds.size(); i++)
-               ds[i] = ds_books[i];
+            ds = sample<Data>(*mapped, dataset_size, rng);
             break;
          }
          default:
@@ -254,17 +438,281 @@ namespace dataset {
             key--;
 
       sort_and_deduplicate(ds);
+      return ds;
+   }
+
+   /**
+    * Directory synthetic datasets are persisted to, i.e., generated only once per machine
+    */
+   static const std::string SyntheticDir = "data/synthetic";
+
+   /**
+    * @return whether the dataset is generated from a random distribution and worth persisting
+    */
+   inline bool synthetic(ID id) {
+      return id == ID::GAPPED_10 || id == ID::UNIFORM || id == ID::NORMAL;
+   }
+
+   /**
+    * @return path of the persisted dataset, named like the SOSD files, e.g., uniform_200000000_uint64
+    */
+   template<class Data>
+   std::string synthetic_path(ID id, size_t dataset_size) {
+      return SyntheticDir + "/" + name(id) + "_" + std::to_string(dataset_size) + "_uint" +
+         std::to_string(sizeof(Data) * 8);
+   }
 
-      // cache dataset for future use
-      const auto it = datasets.find(id);
-      if (it == datasets.end()) {
-         std::unordered_map<size_t, std::vector<Data>> map;
-         map.insert({dataset_size, ds});
-         datasets.insert({id, map});
+   namespace _ {
+      inline std::uint64_t seed(const std::uint64_t& tag, const size_t& dataset_size) {
+         // splitmix64 finalizer
+         std::uint64_t z = (tag << 56) ^ dataset_size;
+         z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+         z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+         return z ^ (z >> 31);
+      }
+   } // namespace _
+
+   /**
+    * Seed derived from the dataset id and size only, i.e., each dataset is reproducible
+    */
+   inline std::uint64_t seed(ID id, size_t dataset_size) {
+      return _::seed(static_cast<std::uint64_t>(id), dataset_size);
+   }
+
+   /**
+    * Writes keys in the SOSD format (8 byte key count followed by the keys, little endian).
+    * The file is written under a temporary name and renamed afterwards, i.e., concurrent
+    * runs never observe partial files. Failures are reported but not fatal
+    */
+   template<class Key>
+   void store(const std::string& filepath, const std::vector<Key>& keys) {
+      static_assert(std::endian::native == std::endian::little, "keys are written in place");
+
+      std::error_code ec;
+      std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), ec);
+      const auto tmp = filepath + ".tmp" + std::to_string(::getpid());
+      {
+         std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+         const std::uint64_t count = keys.size();
+         out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+         out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(Key)));
+         if (!out) {
+            std::cerr << "could not write dataset '" << filepath << "'" << std::endl;
+            std::filesystem::remove(tmp, ec);
+            return;
+         }
+      }
+      std::filesystem::rename(tmp, filepath, ec);
+      if (ec) {
+         std::cerr << "could not write dataset '" << filepath << "': " << ec.message() << std::endl;
+         std::filesystem::remove(tmp, ec);
+      }
+   }
+
+   namespace _ {
+      /**
+       * @return keys, which keep owner (i.e., the vector or mapping they point into) alive
+       */
+      template<class Data, class Owner>
+      std::shared_ptr<const std::span<const Data>> share(std::shared_ptr<const Owner> owner,
+                                                         std::span<const Data> keys) {
+         return {new std::span<const Data>(keys), [owner = std::move(owner)](const std::span<const Data>* keys) {
+                    delete keys;
+                 }};
+      }
+
+      template<class Data>
+      std::shared_ptr<const std::span<const Data>> share(std::vector<Data>&& keys) {
+         auto owner = std::make_shared<const std::vector<Data>>(std::move(keys));
+         return share<Data>(owner, std::span<const Data>(*owner));
+      }
+   } // namespace _
+
+   /**
+    * Synthetic datasets are generated once with a deterministic seed and persisted to
+    * SyntheticDir in the SOSD format. Subsequent runs map the file instead of regenerating,
+    * and the keys are used in place, i.e., the mapping stays alive as long as the keys
+    *
+    * @return the sorted and deduplicated dataset
+    */
+   template<class Data>
+   std::shared_ptr<const std::span<const Data>> load_synthetic(ID id, size_t dataset_size) {
+      const auto filepath = synthetic_path<Data>(id, dataset_size);
+      if (std::filesystem::exists(filepath)) {
+         std::cerr << "mapping dataset " << filepath << std::endl;
+         try {
+            auto mapped = std::make_shared<const MappedDataset<Data>>(filepath);
+            // guards against files not written by store()
+            const auto keys = mapped->keys();
+            if (mapped->sorted() && std::adjacent_find(keys.begin(), keys.end()) == keys.end())
+               return _::share<Data>(std::move(mapped), keys);
+         } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+         }
+         std::cerr << "regenerating invalid dataset '" << filepath << "'" << std::endl;
+      }
+
+      std::mt19937_64 rng(seed(id, dataset_size));
+      auto ds = generate<Data>(id, dataset_size, rng);
+      store(filepath, ds);
+      return _::share(std::move(ds));
+   }
+
+   /**
+    * @return the sorted and deduplicated dataset, generated (or sampled) once and cached
+    *    afterwards. Empty if the dataset is unavailable
+    */
+   template<class Data = std::uint64_t>
+   std::shared_ptr<const std::span<const Data>> load_cached(ID id, size_t dataset_size) {
+      const auto key = cache_key<Data>(name(id), dataset_size, false);
+      if (auto cached = Cache::instance().get<std::span<const Data>>(key))
+         return cached;
+
+      std::shared_ptr<const std::span<const Data>> ds;
+      if (synthetic(id)) {
+         ds = load_synthetic<Data>(id, dataset_size);
       } else {
-         it->second.insert({dataset_size, ds});
+         std::mt19937_64 rng(seed(id, dataset_size));
+         ds = _::share(generate<Data>(id, dataset_size, rng));
       }
 
+      // unavailable datasets are retried on the next call
+      if (!ds->empty())
+         Cache::instance().put(key, ds);
       return ds;
    }
+
+   enum class StringID
+   {
+      URLS = 0,
+      EMAILS = 1,
+      TOKENS = 2
+   };
+
+   inline std::string name(StringID id) {
+      switch (id) {
+         case StringID::URLS:
+            return "urls";
+         case StringID::EMAILS:
+            return "emails";
+         case StringID::TOKENS:
+            return "tokens";
+      }
+      return "unnamed";
+   };
+
+   /**
+    * Seed derived from the string dataset id and size only, distinct from the seeds of integer datasets
+    */
+   inline std::uint64_t seed(StringID id, size_t dataset_size) {
+      return _::seed(0x80 | static_cast<std::uint64_t>(id), dataset_size);
+   }
+
+   /**
+    * Generates synthetic variable-length string keys. Lengths roughly follow real world data:
+    * urls 30-120 bytes, emails 15-40 bytes and tokens 1-64 bytes (mostly below 16 bytes)
+    */
+   inline std::shared_ptr<const std::span<const std::string>> load_cached(StringID id, size_t dataset_size) {
+      const auto key = cache_key<std::string>(name(id), dataset_size, false);
+      if (auto cached = Cache::instance().get<std::span<const std::string>>(key))
+         return cached;
+
+      // deterministic seed, i.e., string datasets are reproducible like the integer ones
+      std::mt19937_64 rng(seed(id, dataset_size));
+
+      static const std::vector<std::string> words{
+         "alpha", "index",  "data",   "search", "news",  "product", "user",  "cart",    "home",  "blog",
+         "media", "images", "static", "api",    "v1",    "v2",      "docs",  "account", "login", "profile",
+         "shop",  "sale",   "item",   "query",  "video", "music",   "sport", "travel",  "food",  "weather"};
+      static const std::vector<std::string> tlds{"com", "org", "net", "de", "io", "co.uk", "fr", "info"};
+      static const std::string alnum = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+      std::uniform_int_distribution<size_t> word_dist(0, words.size() - 1);
+      std::uniform_int_distribution<size_t> tld_dist(0, tlds.size() - 1);
+      std::uniform_int_distribution<size_t> char_dist(0, alnum.size() - 1);
+      std::uniform_int_distribution<size_t> num_dist(0, 99999);
+
+      const auto random_word = [&]() -> const std::string& { return words[word_dist(rng)]; };
+      const auto random_chars = [&](size_t len) {
+         std::string res(len, ' ');
+         for (auto& c : res)
+            c = alnum[char_dist(rng)];
+         return res;
+      };
+
+      std::vector<std::string> ds(dataset_size);
+      switch (id) {
+         case StringID::URLS: {
+            std::uniform_int_distribution<size_t> depth_dist(1, 5);
+            for (auto& url : ds) {
+               url = "https://www." + random_word() + std::to_string(num_dist(rng) % 1000) + "." + tlds[tld_dist(rng)];
+               for (size_t d = depth_dist(rng); d > 0; d--)
+                  url += "/" + random_word();
+               url += "/" + random_chars(8) + "?id=" + std::to_string(num_dist(rng));
+            }
+            break;
+         }
+         case StringID::EMAILS: {
+            std::uniform_int_distribution<size_t> name_dist(3, 10);
+            for (auto& email : ds)
+               email = random_chars(name_dist(rng)) + "." + random_chars(name_dist(rng)) +
+                  std::to_string(num_dist(rng) % 100) + "@" + random_word() + "." + tlds[tld_dist(rng)];
+            break;
+         }
+         case StringID::TOKENS: {
+            // geometric lengths, i.e., mostly short tokens with a long tail up to 64 bytes
+            std::geometric_distribution<size_t> len_dist(0.12);
+            for (auto& token : ds)
+               token = random_chars(std::min(len_dist(rng) + 1, static_cast<size_t>(64)));
+            break;
+         }
+         default:
+            throw std::runtime_error("invalid string datastet id " +
+                                     std::to_string(static_cast<std::underlying_type<StringID>::type>(id)));
+      }
+
+      sort_and_deduplicate(ds);
+
+      auto res = _::share(std::move(ds));
+      Cache::instance().put(key, res);
+      return res;
+   }
+
+   namespace _ {
+      template<class Data>
+      std::shared_ptr<const std::vector<Data>> shuffled(const std::string& key,
+                                                        const std::shared_ptr<const std::span<const Data>>& sorted) {
+         static std::random_device rd;
+         static std::default_random_engine rng(rd());
+
+         std::vector<Data> ds(sorted->begin(), sorted->end());
+         if (ds.empty())
+            return std::make_shared<const std::vector<Data>>();
+
+         parallel::shuffle(ds, rng);
+         auto res = std::make_shared<const std::vector<Data>>(std::move(ds));
+         Cache::instance().put(key, res);
+         return res;
+      }
+   } // namespace _
+
+   /**
+    * Shuffled copy of load_cached(id, dataset_size), which is cached as well, i.e., all
+    * benchmarks on the same dataset share one random order instead of each shuffling
+    * their own copy
+    */
+   template<class Data = std::uint64_t>
+   std::shared_ptr<const std::vector<Data>> load_shuffled(ID id, size_t dataset_size) {
+      const auto key = cache_key<Data>(name(id), dataset_size, true);
+      if (auto cached = Cache::instance().get<std::vector<Data>>(key))
+         return cached;
+      return _::shuffled(key, load_cached<Data>(id, dataset_size));
+   }
+
+   inline std::shared_ptr<const std::vector<std::string>> load_shuffled(StringID id, size_t dataset_size) {
+      const auto key = cache_key<std::string>(name(id), dataset_size, true);
+      if (auto cached = Cache::instance().get<std::vector<std::string>>(key))
+         return cached;
+      return _::shuffled(key, load_cached(id, dataset_size));
+   }
 }; // namespace dataset
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace memory {
+   static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+   /**
+    * Anonymous, zero initialized and prefaulted memory mapping. With huge pages, the
+    * mapping is huge page aligned and transparent huge pages are requested (whether the
+    * kernel grants them depends on /sys/kernel/mm/transparent_hugepage). Without, they
+    * are explicitly disabled so that measurements include regular TLB misses
+    */
+   struct Buffer {
+      /**
+       * @throws std::runtime_error if the memory can not be mapped
+       */
+      Buffer(const size_t& bytes, const bool& huge_pages) : size_(bytes) {
+         mapped = huge_pages ? ((bytes + HugePageSize - 1) / HugePageSize + 1) * HugePageSize : bytes;
+         void* addr = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         if (addr == MAP_FAILED)
+            throw std::runtime_error("could not map " + std::to_string(mapped) + " bytes: " + std::strerror(errno));
+         base = static_cast<char*>(addr);
+
+         // align the usable range to a huge page boundary, i.e., the first page is not split
+         data_ = huge_pages ? reinterpret_cast<char*>((reinterpret_cast<size_t>(base) + HugePageSize - 1) &
+                                                      ~(HugePageSize - 1))
+                            : base;
+         // transparent huge pages only back entire aligned 2 MiB regions, i.e., advise all of them
+         // (the mapping reserves one extra huge page for alignment, so they are within bounds)
+         ::madvise(data_, huge_pages ? (bytes + HugePageSize - 1) / HugePageSize * HugePageSize : bytes,
+                   huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+
+         // fault in all pages now instead of during measurements
+         std::memset(data_, 0, bytes);
+      }
+
+      Buffer(const Buffer&) = delete;
+      Buffer& operator=(const Buffer&) = delete;
+
+      ~Buffer() {
+         ::munmap(base, mapped);
+      }
+
+      template<class T = char>
+      T* data() const {
+         return reinterpret_cast<T*>(data_);
+      }
+
+      size_t size() const {
+         return size_;
+      }
+
+     private:
+      char* base = nullptr;
+      char* data_ = nullptr;
+      size_t size_ = 0;
+      size_t mapped = 0;
+   };
+} // namespace memory
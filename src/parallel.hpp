@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Multithreaded replacements for std::sort + std::unique and std::shuffle,
+ * used to prepare datasets of up to hundreds of millions of keys
+ */
+namespace parallel {
+   namespace _ {
+      /// inputs smaller than this are processed on a single thread
+      static constexpr size_t MinParallelSize = 1 << 20;
+
+      inline size_t num_threads(const size_t& n) {
+         if (n < MinParallelSize)
+            return 1;
+         return std::max(std::thread::hardware_concurrency(), 1U);
+      }
+
+      /**
+       * calls fn(t) for t in [0, threads) on threads threads, including the calling one
+       */
+      template<class Fn>
+      void run(const size_t& threads, const Fn& fn) {
+         std::vector<std::thread> workers;
+         workers.reserve(threads - 1);
+         for (size_t t = 1; t < threads; t++)
+            workers.emplace_back(fn, t);
+         fn(0);
+         for (auto& worker : workers)
+            worker.join();
+      }
+
+      /**
+       * @return [begin, end) of the t-th of threads contiguous chunks of [0, n)
+       */
+      inline std::pair<size_t, size_t> chunk(const size_t& n, const size_t& threads, const size_t& t) {
+         const size_t per_thread = (n + threads - 1) / threads;
+         const size_t begin = std::min(t * per_thread, n);
+         return {begin, std::min(begin + per_thread, n)};
+      }
+
+      /**
+       * moves src[0, n) to dst[0, n) in parallel
+       */
+      template<class T>
+      void move(T* src, T* dst, const size_t& n, const size_t& threads) {
+         run(threads, [&](const size_t t) {
+            const auto [begin, end] = chunk(n, threads, t);
+            std::move(src + begin, src + end, dst + begin);
+         });
+      }
+
+      inline std::uint64_t splitmix64(std::uint64_t& state) {
+         std::uint64_t z = (state += 0x9E3779B97F4A7C15);
+         z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+         z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+         return z ^ (z >> 31);
+      }
+
+      /**
+       * Counting pass followed by a stable scatter pass, i.e., one round of a parallel
+       * (LSD) radix sort: each thread counts the buckets of its chunk, bucket offsets are
+       * assigned bucket major, thread minor, and each thread scatters its chunk
+       *
+       * @param bucket_of functor returning a stateful bucket function per thread,
+       *    invoked once for counting and once for scattering
+       * @param bounds if not null, receives the Buckets + 1 bucket boundaries in dst
+       * @return whether all elements ended up in the same bucket (dst is not written then)
+       */
+      template<size_t Buckets, class T, class BucketFn>
+      bool scatter(T* src, T* dst, const size_t& n, const size_t& threads, const BucketFn& bucket_of,
+                   const bool skip_trivial, size_t* bounds = nullptr) {
+         std::vector<std::array<size_t, Buckets>> offsets(threads);
+         run(threads, [&](const size_t t) {
+            const auto [begin, end] = chunk(n, threads, t);
+            auto& counts = offsets[t];
+            counts.fill(0);
+            auto bucket = bucket_of(t);
+            for (size_t i = begin; i < end; i++)
+               counts[bucket(src[i])]++;
+         });
+
+         size_t sum = 0;
+         for (size_t b = 0; b < Buckets; b++) {
+            if (bounds != nullptr)
+               bounds[b] = sum;
+            size_t total = 0;
+            for (size_t t = 0; t < threads; t++) {
+               const size_t cnt = offsets[t][b];
+               offsets[t][b] = sum;
+               sum += cnt;
+               total += cnt;
+            }
+            if (skip_trivial && total == n)
+               return true;
+         }
+         if (bounds != nullptr)
+            bounds[Buckets] = sum;
+
+         run(threads, [&](const size_t t) {
+            const auto [begin, end] = chunk(n, threads, t);
+            auto& pos = offsets[t];
+            auto bucket = bucket_of(t);
+            for (size_t i = begin; i < end; i++)
+               dst[pos[bucket(src[i])]++] = std::move(src[i]);
+         });
+         return false;
+      }
+   } // namespace _
+
+   /**
+    * Sorts vec and removes duplicates. Unsigned integers are sorted by a parallel LSD
+    * radix sort (8 bits per pass, passes in which all keys share the same digit are
+    * skipped), other types fall back to std::sort
+    */
+   template<class T>
+   void sort_and_deduplicate(std::vector<T>& vec) {
+      const size_t n = vec.size();
+      const size_t threads = _::num_threads(n);
+      if constexpr (!std::is_unsigned_v<T>) {
+         std::sort(vec.begin(), vec.end());
+         vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+         vec.shrink_to_fit();
+         return;
+      } else {
+         if (threads == 1) {
+            std::sort(vec.begin(), vec.end());
+            vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+            vec.shrink_to_fit();
+            return;
+         }
+
+         std::unique_ptr<T[]> buffer(new T[n]);
+         T* src = vec.data();
+         T* dst = buffer.get();
+         for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+            const auto digit = [shift](const size_t) {
+               return [shift](const T& key) { return static_cast<size_t>((key >> shift) & 0xFF); };
+            };
+            if (!_::scatter<256>(src, dst, n, threads, digit, true))
+               std::swap(src, dst);
+         }
+
+         // deduplicate into the other buffer: each thread keeps the first occurrence of
+         // every key in its chunk, i.e., elements differing from their predecessor
+         std::vector<size_t> offsets(threads + 1, 0);
+         _::run(threads, [&](const size_t t) {
+            const auto [begin, end] = _::chunk(n, threads, t);
+            for (size_t i = begin; i < end; i++)
+               offsets[t + 1] += i == 0 || src[i] != src[i - 1];
+         });
+         for (size_t t = 0; t < threads; t++)
+            offsets[t + 1] += offsets[t];
+         _::run(threads, [&](const size_t t) {
+            const auto [begin, end] = _::chunk(n, threads, t);
+            for (size_t i = begin, pos = offsets[t]; i < end; i++)
+               if (i == 0 || src[i] != src[i - 1])
+                  dst[pos++] = src[i];
+         });
+
+         const size_t unique = offsets[threads];
+         std::vector<T> res(unique);
+         _::move(dst, res.data(), unique, _::num_threads(unique));
+         vec = std::move(res);
+      }
+   }
+
+   /**
+    * Shuffles vec uniformly at random. Elements are scattered into random blocks, then
+    * each block is shuffled independently, which yields a uniform permutation while
+    * both steps parallelize
+    *
+    * @param rng only used to seed the per thread generators
+    */
+   template<class T, class RNG>
+   void shuffle(std::vector<T>& vec, RNG& rng) {
+      const size_t n = vec.size();
+      const size_t threads = _::num_threads(n);
+      if (threads == 1) {
+         std::shuffle(vec.begin(), vec.end(), rng);
+         return;
+      }
+
+      constexpr size_t Blocks = 1024;
+      std::vector<std::uint64_t> seeds(threads);
+      for (auto& seed : seeds)
+         seed = (static_cast<std::uint64_t>(rng()) << 32) ^ static_cast<std::uint64_t>(rng());
+
+      // the block sequence of each thread is generated twice (counting, scattering) from the same seed
+      std::unique_ptr<T[]> buffer(new T[n]);
+      const auto random_block = [&](const size_t t) {
+         return [state = seeds[t]](const T&) mutable {
+            return static_cast<size_t>((static_cast<unsigned __int128>(_::splitmix64(state)) * Blocks) >> 64);
+         };
+      };
+      std::array<size_t, Blocks + 1> bounds;
+      _::scatter<Blocks>(vec.data(), buffer.get(), n, threads, random_block, false, bounds.data());
+
+      _::run(threads, [&](const size_t t) {
+         std::mt19937_64 block_rng(seeds[t] ^ 0xD6E8FEB86659FD93);
+         for (size_t b = t; b < Blocks; b += threads)
+            std::shuffle(buffer.get() + bounds[b], buffer.get() + bounds[b + 1], block_rng);
+      });
+
+      _::move(buffer.get(), vec.data(), n, threads);
+   }
+} // namespace parallel
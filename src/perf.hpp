@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+namespace perf {
+   struct Event {
+      std::string name;
+      std::uint32_t type;
+      std::uint64_t config;
+   };
+
+   namespace _ {
+      constexpr std::uint64_t cache_event(const std::uint64_t cache, const std::uint64_t op,
+                                          const std::uint64_t result) {
+         return cache | (op << 8) | (result << 16);
+      }
+   } // namespace _
+
+   /**
+    * Generic events, mapped to the cpu's native events by the kernel
+    */
+   inline std::vector<Event> default_events() {
+      return {{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+              {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+              {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+              {"l1d_misses", PERF_TYPE_HW_CACHE,
+               _::cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+              {"llc_misses", PERF_TYPE_HW_CACHE,
+               _::cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)}};
+   }
+
+   /**
+    * Cpu specific raw events given as comma separated name=code pairs in the
+    * HASHING_PERF_EVENTS environment variable, e.g., uop port utilization on
+    * Intel Skylake: "uops_port_0=0x1a1,uops_port_1=0x2a1,uops_port_5=0x20a1".
+    * Event codes are listed by `perf list --details` or the vendor's manual
+    */
+   inline std::vector<Event> env_events() {
+      const char* env = std::getenv("HASHING_PERF_EVENTS");
+      if (env == nullptr)
+         return {};
+
+      std::vector<Event> res;
+      const std::string spec(env);
+      for (size_t begin = 0; begin < spec.size();) {
+         size_t end = spec.find(',', begin);
+         if (end == std::string::npos)
+            end = spec.size();
+
+         const auto entry = spec.substr(begin, end - begin);
+         const auto eq = entry.find('=');
+         if (eq != std::string::npos && eq > 0)
+            res.push_back({entry.substr(0, eq), PERF_TYPE_RAW, std::strtoull(entry.c_str() + eq + 1, nullptr, 0)});
+         begin = end + 1;
+      }
+      return res;
+   }
+
+   inline std::vector<Event> all_events() {
+      auto res = default_events();
+      const auto raw = env_events();
+      res.insert(res.end(), raw.begin(), raw.end());
+      return res;
+   }
+
+   /**
+    * Counts hardware events of the calling thread and all threads it spawns while counting.
+    * Events that can not be opened, e.g., since the cpu does not support them, the kernel
+    * restricts access (perf_event_paranoid) or we run in a vm, are silently omitted
+    */
+   struct Counters {
+      explicit Counters(const std::vector<Event>& events = all_events()) {
+         for (const auto& event : events) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = event.type;
+            attr.config = event.config;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // events are scaled if the kernel has to multiplex them
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd >= 0)
+               counters.push_back({event.name, fd, 0});
+         }
+      }
+
+      Counters(const Counters&) = delete;
+      Counters& operator=(const Counters&) = delete;
+
+      ~Counters() {
+         for (const auto& counter : counters)
+            ::close(counter.fd);
+      }
+
+      void start() {
+         for (const auto& counter : counters) {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+         }
+      }
+
+      void stop() {
+         for (auto& counter : counters) {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            std::uint64_t values[3] = {0, 0, 0};
+            if (::read(counter.fd, values, sizeof(values)) != sizeof(values) || values[2] == 0) {
+               counter.value = 0;
+               continue;
+            }
+            counter.value = static_cast<double>(values[0]) * static_cast<double>(values[1]) /
+               static_cast<double>(values[2]);
+         }
+      }
+
+      /**
+       * Reports all counted events per key (e.g., cycles_per_key) and the
+       * instructions per cycle
+       */
+      void report(benchmark::State& state, const double& keys) const {
+         double cycles = 0, instructions = 0;
+         for (const auto& counter : counters) {
+            if (keys > 0)
+               state.counters[counter.name + "_per_key"] = counter.value / keys;
+            if (counter.name == "cycles")
+               cycles = counter.value;
+            if (counter.name == "instructions")
+               instructions = counter.value;
+         }
+         if (cycles > 0 && instructions > 0)
+            state.counters["ipc"] = instructions / cycles;
+      }
+
+     private:
+      struct Counter {
+         std::string name;
+         int fd;
+         double value;
+      };
+      std::vector<Counter> counters;
+   };
+} // namespace perf
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <hashing.hpp>
+
+#include "./datasets.hpp"
+#include "./parallel.hpp"
+
+/**
+ * Hash quality suite. Every function registered for 32 and 64 bit keys is evaluated
+ * on every available dataset::ID, one (function, dataset) pair per thread:
+ *
+ *  - avalanche: probability that flipping input bit i flips output bit j. Reported
+ *    as the maximum and mean bias |2p - 1| over all (i, j), optionally as full matrix
+ *  - bit independence criterion (BIC): correlation between the flips of output bits
+ *    j and k when flipping input bit i. Reported as the maximum |correlation|
+ *  - chi-square uniformity: z-score of the chi-square statistic over B buckets, once
+ *    for the upper bits (fastrange) and once for the lower bits (modulo). An ideal
+ *    function yields |z| of a few at most
+ *  - collisions: equal full width outputs among distinct keys, compared to the
+ *    expected amount n(n - 1) / 2^(bits + 1) of an ideal random function
+ *
+ * Results are written as csv, one row per (key width, function, dataset)
+ */
+
+struct Options {
+   /// keys per dataset used for chi-square and collision counts
+   size_t size = 10'000'000;
+   /// keys per dataset used for avalanche and BIC
+   size_t sample = 1 << 14;
+   /// bucket counts for chi-square
+   std::vector<size_t> buckets{1 << 10, 1 << 16, 1 << 20};
+   size_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+   /// avalanche matrices are written to this directory if not empty
+   std::string matrix_dir;
+   /// results are written to this file, or stdout if empty
+   std::string out;
+};
+
+struct Avalanche {
+   /// flip probability of output bit j when flipping input bit i at [i * out_bits + j]
+   std::vector<double> matrix;
+   double max_bias = 0;
+   double mean_bias = 0;
+   double max_bic = 0;
+};
+
+/**
+ * Flip indicators are stored transposed, one bitset over the sample per output bit, such
+ * that flip and joint flip counts are popcounts over those bitsets
+ */
+template<class Key>
+static Avalanche avalanche(const hashing::registry::BatchFn<Key>& hashfn, const std::vector<Key>& sample,
+                           const size_t& out_bits) {
+   constexpr size_t in_bits = sizeof(Key) * 8;
+   const size_t n = sample.size();
+   const size_t words = (n + 63) / 64;
+
+   std::vector<HASH_64> base(n), hashes(n);
+   std::vector<Key> flipped(n);
+   std::vector<std::uint64_t> columns(out_bits * words);
+   std::vector<size_t> flips(out_bits);
+   hashfn(sample.data(), n, base.data());
+
+   Avalanche res;
+   res.matrix.resize(in_bits * out_bits);
+   for (size_t i = 0; i < in_bits; i++) {
+      for (size_t k = 0; k < n; k++)
+         flipped[k] = sample[k] ^ (static_cast<Key>(1) << i);
+      hashfn(flipped.data(), n, hashes.data());
+
+      std::fill(columns.begin(), columns.end(), 0);
+      for (size_t k = 0; k < n; k++)
+         for (auto diff = base[k] ^ hashes[k]; diff != 0; diff &= diff - 1) {
+            const auto j = static_cast<size_t>(std::countr_zero(diff));
+            columns[j * words + k / 64] |= static_cast<std::uint64_t>(1) << (k % 64);
+         }
+
+      for (size_t j = 0; j < out_bits; j++) {
+         flips[j] = 0;
+         for (size_t w = 0; w < words; w++)
+            flips[j] += std::popcount(columns[j * words + w]);
+
+         const double p = static_cast<double>(flips[j]) / static_cast<double>(n);
+         const double bias = std::abs(2.0 * p - 1.0);
+         res.matrix[i * out_bits + j] = p;
+         res.max_bias = std::max(res.max_bias, bias);
+         res.mean_bias += bias;
+      }
+
+      for (size_t j = 0; j < out_bits; j++)
+         for (size_t l = j + 1; l < out_bits; l++) {
+            size_t joint = 0;
+            for (size_t w = 0; w < words; w++)
+               joint += std::popcount(columns[j * words + w] & columns[l * words + w]);
+
+            const double pj = static_cast<double>(flips[j]) / static_cast<double>(n);
+            const double pl = static_cast<double>(flips[l]) / static_cast<double>(n);
+            const double variance = pj * (1.0 - pj) * pl * (1.0 - pl);
+            // constant bits are already reported as maximum avalanche bias
+            if (variance <= 0)
+               continue;
+            const double corr = (static_cast<double>(joint) / static_cast<double>(n) - pj * pl) / std::sqrt(variance);
+            res.max_bic = std::max(res.max_bic, std::abs(corr));
+         }
+   }
+   res.mean_bias /= static_cast<double>(in_bits * out_bits);
+
+   return res;
+}
+
+/**
+ * @param high use the upper output bits (fastrange) instead of the lower bits (modulo)
+ * @return z-score of the chi-square statistic, i.e., (chi2 - dof) / sqrt(2 dof)
+ */
+static double chi_square_z(const std::vector<HASH_64>& hashes, const size_t& out_bits, const size_t& buckets,
+                           const bool& high) {
+   std::vector<std::uint32_t> counts(buckets, 0);
+   for (const auto& hash : hashes) {
+      const auto bucket = high ? static_cast<size_t>((static_cast<unsigned __int128>(hash) * buckets) >> out_bits)
+                               : static_cast<size_t>(hash % buckets);
+      counts[bucket]++;
+   }
+
+   const double expected = static_cast<double>(hashes.size()) / static_cast<double>(buckets);
+   double chi2 = 0;
+   for (const auto& count : counts)
+      chi2 += (count - expected) * (count - expected) / expected;
+
+   const double dof = static_cast<double>(buckets - 1);
+   return (chi2 - dof) / std::sqrt(2.0 * dof);
+}
+
+/**
+ * @return amount of equal hashes, i.e., the hashes are sorted in place
+ */
+static size_t collisions(std::vector<HASH_64>& hashes) {
+   std::sort(hashes.begin(), hashes.end());
+   size_t res = 0;
+   for (size_t i = 1; i < hashes.size(); i++)
+      res += hashes[i] == hashes[i - 1];
+   return res;
+}
+
+template<class Key>
+struct Job {
+   std::string hashfn;
+   dataset::ID ds_id;
+   const std::vector<Key>* keys;
+   const std::vector<Key>* sample;
+};
+
+static std::string matrix_path(const Options& options, const std::string& hashfn, const dataset::ID& ds_id,
+                               const size_t& key_bits) {
+   return options.matrix_dir + "/avalanche_" + std::to_string(key_bits) + "_" + hashfn + "_" + dataset::name(ds_id) +
+      ".csv";
+}
+
+template<class Key>
+static std::string evaluate(const Job<Key>& job, const Options& options) {
+   const auto& hashfn = hashing::registry::Registry<Key>::defaults().get(job.hashfn);
+   const auto& keys = *job.keys;
+
+   std::vector<HASH_64> hashes(keys.size());
+   hashfn(keys.data(), keys.size(), hashes.data());
+   // declared rather than observed width, i.e., 64-bit functions whose hashes never set their
+   // upper bits on a dataset are graded (and penalized) as 64-bit functions
+   const size_t out_bits = hashing::registry::Registry<Key>::defaults().bits(job.hashfn);
+
+   const auto av = avalanche(hashfn, *job.sample, out_bits);
+   if (!options.matrix_dir.empty()) {
+      std::ofstream matrix(matrix_path(options, job.hashfn, job.ds_id, sizeof(Key) * 8));
+      for (size_t i = 0; i < sizeof(Key) * 8; i++)
+         for (size_t j = 0; j < out_bits; j++)
+            matrix << av.matrix[i * out_bits + j] << (j + 1 < out_bits ? "," : "\n");
+   }
+
+   std::stringstream row;
+   row << std::setprecision(6) << sizeof(Key) * 8 << "," << job.hashfn << "," << dataset::name(job.ds_id) << ","
+       << keys.size() << "," << out_bits << "," << av.max_bias << "," << av.mean_bias << "," << av.max_bic;
+
+   for (const auto& buckets : options.buckets)
+      row << "," << chi_square_z(hashes, out_bits, buckets, true) << ","
+          << chi_square_z(hashes, out_bits, buckets, false);
+
+   const double n = static_cast<double>(keys.size());
+   row << "," << collisions(hashes) << "," << n * (n - 1.0) / std::pow(2.0, static_cast<double>(out_bits) + 1.0);
+
+   return row.str();
+}
+
+/**
+ * Keys of all available datasets, truncated to Key and deduplicated, in random order
+ */
+template<class Key>
+static std::vector<std::pair<dataset::ID, std::vector<Key>>> load_all(const Options& options) {
+   std::vector<std::pair<dataset::ID, std::vector<Key>>> res;
+   std::default_random_engine rng(42);
+
+   for (const auto id : {dataset::ID::SEQUENTIAL, dataset::ID::GAPPED_10, dataset::ID::UNIFORM, dataset::ID::NORMAL,
+                         dataset::ID::BOOKS, dataset::ID::FB, dataset::ID::OSM, dataset::ID::WIKI}) {
+      const auto ds = dataset::load_cached(id, options.size);
+      if (ds->empty()) {
+         std::cerr << "skipping unavailable dataset " << dataset::name(id) << std::endl;
+         continue;
+      }
+
+      std::vector<Key> keys(ds->begin(), ds->end());
+      dataset::sort_and_deduplicate(keys);
+      parallel::shuffle(keys, rng);
+      res.emplace_back(id, std::move(keys));
+   }
+   return res;
+}
+
+template<class Key>
+static void add_jobs(const std::vector<std::pair<dataset::ID, std::vector<Key>>>& datasets,
+                     const std::vector<std::vector<Key>>& samples, std::vector<Job<Key>>& jobs) {
+   for (const auto& name : hashing::registry::Registry<Key>::defaults().names())
+      for (size_t d = 0; d < datasets.size(); d++)
+         jobs.push_back({name, datasets[d].first, &datasets[d].second, &samples[d]});
+}
+
+template<class Key>
+static std::vector<std::vector<Key>> samples(const std::vector<std::pair<dataset::ID, std::vector<Key>>>& datasets,
+                                             const Options& options) {
+   std::vector<std::vector<Key>> res;
+   for (const auto& [id, keys] : datasets)
+      res.emplace_back(keys.begin(), keys.begin() + std::min(options.sample, keys.size()));
+   return res;
+}
+
+static std::vector<size_t> parse_list(const std::string& list) {
+   std::vector<size_t> res;
+   std::stringstream ss(list);
+   for (std::string item; std::getline(ss, item, ',');)
+      res.push_back(std::stoull(item));
+   return res;
+}
+
+static Options parse(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; i++) {
+      const std::string arg(argv[i]);
+      const auto eq = arg.find('=');
+      const auto key = arg.substr(0, eq);
+      const auto value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+      if (key == "--size")
+         options.size = std::stoull(value);
+      else if (key == "--sample")
+         options.sample = std::stoull(value);
+      else if (key == "--buckets")
+         options.buckets = parse_list(value);
+      else if (key == "--threads")
+         options.threads = std::max(std::stoull(value), 1ULL);
+      else if (key == "--matrix_dir")
+         options.matrix_dir = value;
+      else if (key == "--out")
+         options.out = value;
+      else
+         throw std::invalid_argument(
+            "unknown argument '" + arg +
+            "'. Usage: ha_quality [--size=N] [--sample=N] [--buckets=B1,B2,...] [--threads=N] [--matrix_dir=DIR] "
+            "[--out=FILE]");
+   }
+
+   if (options.sample == 0)
+      throw std::invalid_argument("sample size must be positive");
+   for (const auto& buckets : options.buckets)
+      if (buckets < 2 || buckets > std::numeric_limits<std::uint32_t>::max())
+         throw std::invalid_argument("bucket counts must be in [2, 2^32)");
+
+   return options;
+}
+
+int main(int argc, char** argv) {
+   const auto options = parse(argc, argv);
+
+   // statistics of an incorrectly ported function are meaningless, hence verify against the reference test vectors
+   if (hashing::dispatch::supported<hashing::AquaHash<HASH_64>>()) {
+      const int failed_line = hashing::AquaHash<HASH_64>::VerifyImplementation();
+      if (failed_line != 0) {
+         std::cerr << "AquaHash self test failed (aqua.hpp:" << failed_line << ")" << std::endl;
+         return 1;
+      }
+   }
+
+   const auto datasets32 = load_all<HASH_32>(options);
+   const auto datasets64 = load_all<HASH_64>(options);
+   const auto samples32 = samples(datasets32, options);
+   const auto samples64 = samples(datasets64, options);
+
+   std::vector<Job<HASH_32>> jobs32;
+   std::vector<Job<HASH_64>> jobs64;
+   add_jobs(datasets32, samples32, jobs32);
+   add_jobs(datasets64, samples64, jobs64);
+
+   // jobs take vastly different amounts of time, hence they are claimed one at a time
+   const size_t total = jobs32.size() + jobs64.size();
+   std::vector<std::string> rows(total);
+   std::atomic<size_t> next{0};
+   const auto work = [&] {
+      for (size_t j = next.fetch_add(1); j < total; j = next.fetch_add(1))
+         rows[j] = j < jobs32.size() ? evaluate(jobs32[j], options) : evaluate(jobs64[j - jobs32.size()], options);
+   };
+
+   std::vector<std::thread> workers;
+   for (size_t t = 1; t < std::min(options.threads, total); t++)
+      workers.emplace_back(work);
+   work();
+   for (auto& worker : workers)
+      worker.join();
+
+   std::ofstream file;
+   if (!options.out.empty())
+      file.open(options.out);
+   std::ostream& out = options.out.empty() ? std::cout : file;
+
+   out << "key_bits,hashfn,dataset,keys,output_bits,avalanche_max_bias,avalanche_mean_bias,bic_max_correlation";
+   for (const auto& buckets : options.buckets)
+      out << ",chi2_z_high_" << buckets << ",chi2_z_low_" << buckets;
+   out << ",collisions,expected_collisions" << std::endl;
+   for (const auto& row : rows)
+      out << row << std::endl;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "include/convenience/builtins.hpp"
+
+/**
+ * Minimal hash tables used to benchmark hash function and reducer combinations
+ * at the table level. Tables store keys only and do not hash themselves: callers
+ * pass the already reduced bucket index (and an alternative index for tables with
+ * two choices), which allows hashing in batches using type erased functions.
+ * Keys are assumed to be unique and std::numeric_limits<Key>::max() marks empty
+ * slots, which dataset::load_cached never produces.
+ *
+ * Probe counts are the amount of slots (linear probing), chain nodes (chaining)
+ * or buckets (cuckoo) inspected by an operation.
+ */
+namespace tables {
+   struct Probe {
+      bool found;
+      size_t probes;
+   };
+
+   template<class Key>
+   struct LinearProbing {
+      static constexpr size_t Choices = 1;
+      static constexpr Key Empty = std::numeric_limits<Key>::max();
+
+      static std::string name() {
+         return "linear_probing";
+      }
+
+      /**
+       * @return amount of buckets (slots) required to store n keys at the given load factor
+       */
+      static size_t buckets(const size_t& n, const double& load_factor) {
+         return static_cast<size_t>(std::ceil(static_cast<double>(n) / load_factor));
+      }
+
+      explicit LinearProbing(const size_t& buckets) : slots(buckets, Empty) {}
+
+      /**
+       * @return amount of probes, or 0 if the table is full
+       */
+      forceinline size_t insert(const Key& key, size_t index, const size_t&) {
+         for (size_t probes = 1; probes <= slots.size(); probes++) {
+            if (slots[index] == Empty) {
+               slots[index] = key;
+               return probes;
+            }
+            index = index + 1 == slots.size() ? 0 : index + 1;
+         }
+         return 0;
+      }
+
+      forceinline Probe lookup(const Key& key, size_t index, const size_t&) const {
+         for (size_t probes = 1; probes <= slots.size(); probes++) {
+            if (slots[index] == key)
+               return {true, probes};
+            if (slots[index] == Empty)
+               return {false, probes};
+            index = index + 1 == slots.size() ? 0 : index + 1;
+         }
+         return {false, slots.size()};
+      }
+
+     private:
+      std::vector<Key> slots;
+   };
+
+   /**
+    * Separate chaining with index linked nodes stored in a single pool
+    */
+   template<class Key>
+   struct Chaining {
+      static constexpr size_t Choices = 1;
+
+      static std::string name() {
+         return "chaining";
+      }
+
+      static size_t buckets(const size_t& n, const double& load_factor) {
+         return static_cast<size_t>(std::ceil(static_cast<double>(n) / load_factor));
+      }
+
+      explicit Chaining(const size_t& buckets) : heads(buckets, None) {
+         nodes.reserve(buckets);
+      }
+
+      /**
+       * Traverses the entire chain (like a duplicate check would) and appends key
+       * @return amount of probes, i.e., chain length before insertion + 1
+       */
+      forceinline size_t insert(const Key& key, const size_t& index, const size_t&) {
+         const auto node = static_cast<std::uint32_t>(nodes.size());
+         nodes.push_back({key, None});
+
+         size_t probes = 1;
+         std::uint32_t* next = &heads[index];
+         for (; *next != None; probes++)
+            next = &nodes[*next].next;
+         *next = node;
+         return probes;
+      }
+
+      forceinline Probe lookup(const Key& key, const size_t& index, const size_t&) const {
+         size_t probes = 0;
+         for (auto node = heads[index]; node != None; node = nodes[node].next) {
+            probes++;
+            if (nodes[node].key == key)
+               return {true, probes};
+         }
+         return {false, probes};
+      }
+
+     private:
+      static constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+      struct Node {
+         Key key;
+         std::uint32_t next;
+      };
+
+      std::vector<std::uint32_t> heads;
+      std::vector<Node> nodes;
+   };
+
+   /**
+    * Bucketized cuckoo hashing with two choices and BucketSize slots per bucket. Entries
+    * remember both of their buckets, i.e., relocating an entry never requires rehashing
+    */
+   template<class Key, size_t BucketSize = 4>
+   struct Cuckoo {
+      static constexpr size_t Choices = 2;
+      static constexpr Key Empty = std::numeric_limits<Key>::max();
+      static constexpr size_t MaxKicks = 500;
+
+      static std::string name() {
+         return "cuckoo_" + std::to_string(BucketSize);
+      }
+
+      static size_t buckets(const size_t& n, const double& load_factor) {
+         return static_cast<size_t>(std::ceil(static_cast<double>(n) / load_factor / BucketSize));
+      }
+
+      explicit Cuckoo(const size_t& buckets) : table(buckets) {
+         for (auto& bucket : table)
+            for (auto& entry : bucket)
+               entry.key = Empty;
+      }
+
+      /**
+       * @return amount of buckets inspected, or 0 if the key could not be placed
+       *    within MaxKicks relocations
+       */
+      forceinline size_t insert(const Key& key, const size_t& index, const size_t& alt_index) {
+         Entry entry{key, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(alt_index)};
+         if (place(entry, index))
+            return 1;
+         if (place(entry, alt_index))
+            return 2;
+
+         // random walk: evict a random entry of the current bucket and move it to its other bucket
+         size_t bucket = index;
+         for (size_t kick = 0; kick < MaxKicks; kick++) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            std::swap(entry, table[bucket][rng % BucketSize]);
+
+            bucket = entry.bucket == bucket ? entry.alt_bucket : entry.bucket;
+            if (place(entry, bucket))
+               return kick + 3;
+         }
+         return 0;
+      }
+
+      forceinline Probe lookup(const Key& key, const size_t& index, const size_t& alt_index) const {
+         if (contains(key, index))
+            return {true, 1};
+         return {contains(key, alt_index), 2};
+      }
+
+     private:
+      struct Entry {
+         Key key;
+         std::uint32_t bucket;
+         std::uint32_t alt_bucket;
+      };
+
+      std::vector<std::array<Entry, BucketSize>> table;
+      std::uint64_t rng = 0x9E3779B97F4A7C15;
+
+      forceinline bool place(const Entry& entry, const size_t& bucket) {
+         for (auto& slot : table[bucket])
+            if (slot.key == Empty) {
+               slot = entry;
+               return true;
+            }
+         return false;
+      }
+
+      forceinline bool contains(const Key& key, const size_t& bucket) const {
+         for (const auto& slot : table[bucket])
+            if (slot.key == key)
+               return true;
+         return false;
+      }
+   };
+} // namespace tables
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace threads {
+   namespace _ {
+      /**
+       * @return the integer stored in a sysfs topology file, or fallback if it is not available
+       */
+      inline int read_topology(const int cpu, const std::string& file, const int fallback) {
+         std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + file);
+         int value;
+         if (in >> value)
+            return value;
+         return fallback;
+      }
+   } // namespace _
+
+   /**
+    * Logical cpus this process may run on, grouped by physical core
+    * (cores in ascending order, siblings of a core in ascending order)
+    */
+   inline std::vector<std::vector<int>> cores() {
+      cpu_set_t allowed;
+      CPU_ZERO(&allowed);
+      if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+         return {{0}};
+
+      std::map<std::pair<int, int>, std::vector<int>> by_core;
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+         if (CPU_ISSET(cpu, &allowed))
+            by_core[{_::read_topology(cpu, "physical_package_id", 0), _::read_topology(cpu, "core_id", cpu)}]
+               .push_back(cpu);
+
+      std::vector<std::vector<int>> res;
+      for (auto& [core, siblings] : by_core)
+         res.push_back(std::move(siblings));
+      std::sort(res.begin(), res.end());
+      return res;
+   }
+
+   /**
+    * Order in which threads are assigned to logical cpus. Without smt, only the first
+    * sibling of every physical core is used, i.e., each thread has a core to itself.
+    * With smt, all siblings of a core are used before moving on to the next core
+    */
+   inline std::vector<int> cpus(const bool smt) {
+      std::vector<int> res;
+      for (const auto& siblings : cores()) {
+         if (smt)
+            res.insert(res.end(), siblings.begin(), siblings.end());
+         else
+            res.push_back(siblings.front());
+      }
+      return res;
+   }
+
+   /**
+    * 1, 2, 4, ... up to and including max
+    */
+   inline std::vector<std::int64_t> counts(const size_t max) {
+      std::vector<std::int64_t> res;
+      for (size_t n = 1; n < max; n *= 2)
+         res.push_back(static_cast<std::int64_t>(n));
+      res.push_back(static_cast<std::int64_t>(max));
+      return res;
+   }
+
+   /**
+    * Pins the calling thread to a single logical cpu
+    * @return whether pinning succeeded
+    */
+   inline bool pin(const int cpu) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+   }
+} // namespace threads